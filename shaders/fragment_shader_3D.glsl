@@ -2,15 +2,21 @@
 
 in vec3 vertexNormal;
 in vec3 fragPos;
+// Material of the instance being drawn
+flat in vec3 objectColor;
+flat in float specularStrength;
+flat in float shininess;
 
 out vec4 FragColor;
 
-uniform vec3 lightDir;
-uniform vec3 lightColor;
-uniform float ambientStrength;
-uniform vec3 objectColor;
-uniform float specularStrength;
-uniform float shininess;
+// Per-frame data, shared by every draw through a uniform buffer
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 lightDir;
+    vec3 lightColor;
+    float ambientStrength;
+};
 
 void main() {
     // Ambient lighting
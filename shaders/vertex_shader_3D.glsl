@@ -3,19 +3,37 @@
 layout (location = 0) in vec3 aPos;   // Vertex position for 3D objects
 layout (location = 1) in vec3 aNormal; // Vertex normal for lighting calculations
 
+// Per-instance attributes, one set per drawn entity
+layout (location = 2) in mat4 instanceModel;    // Takes locations 2 to 5
+layout (location = 6) in vec3 instanceColor;    // Material diffuse color
+layout (location = 7) in vec2 instanceMaterial; // Specular strength, shininess
+
 out vec3 fragPos;        // Fragment position passed to the fragment shader
 out vec3 vertexNormal;   // Normal passed to the fragment shader
+flat out vec3 objectColor;
+flat out float specularStrength;
+flat out float shininess;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Per-frame data, shared by every draw through a uniform buffer
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 lightDir;
+    vec3 lightColor;
+    float ambientStrength;
+};
 
 void main() {
     // Calculate the fragment position in world space
-    fragPos = vec3(model * vec4(aPos, 1.0));
+    fragPos = vec3(instanceModel * vec4(aPos, 1.0));
 
     // Pass the vertex normal to the fragment shader
-    vertexNormal = mat3(transpose(inverse(model))) * aNormal;
+    vertexNormal = mat3(transpose(inverse(instanceModel))) * aNormal;
+
+    // Pass the instance's material to the fragment shader
+    objectColor = instanceColor;
+    specularStrength = instanceMaterial.x;
+    shininess = instanceMaterial.y;
 
     // Calculate the final position of the vertex on screen
     gl_Position = projection * view * vec4(fragPos, 1.0);
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <string>
 
 Shader::Shader(const char *vertexPath, const char *fragmentPath) {
   // 1. Retrieve the vertex/fragment source code from filePath
@@ -82,29 +83,11 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath) {
 
 void Shader::use() { glUseProgram(ID); }
 
-void Shader::setMat4(const std::string &name, const GLfloat *value) {
-  GLint location = glGetUniformLocation(ID, name.c_str());
-  if (location == -1) {
-    std::cerr << "ERROR::SHADER::UNIFORM_NOT_FOUND: " << name << std::endl;
-  } else {
-    glUniformMatrix4fv(location, 1, GL_FALSE, value);
-  }
-}
-
-void Shader::setVec3(const std::string &name, float r, float g, float b) {
-  GLint location = glGetUniformLocation(ID, name.c_str());
-  if (location == -1) {
-    std::cerr << "ERROR::SHADER::UNIFORM_NOT_FOUND: " << name << std::endl;
-  } else {
-    glUniform3f(location, r, g, b);
-  }
-}
-
-void Shader::setFloat(const std::string &name, float value) {
-  GLint location = glGetUniformLocation(ID, name.c_str());
-  if (location == -1) {
-    std::cerr << "ERROR::SHADER::UNIFORM_NOT_FOUND: " << name << std::endl;
-  } else {
-    glUniform1f(location, value);
+bool Shader::bindUniformBlock(const char *name, GLuint binding) {
+  GLuint blockIndex = glGetUniformBlockIndex(ID, name);
+  if (blockIndex == GL_INVALID_INDEX) {
+    return false;
   }
+  glUniformBlockBinding(ID, blockIndex, binding);
+  return true;
 }
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "glad/glad.h"
-#include <string>
 
 class Shader {
 public:
@@ -10,7 +9,8 @@ public:
   Shader(const char *vertexPath, const char *fragmentPath);
 
   void use();
-  void setMat4(const std::string &name, const GLfloat *value);
-  void setVec3(const std::string &name, float x, float y, float z);
-  void setFloat(const std::string &name, float value);
+
+  // Connects the named uniform block to a uniform buffer binding point.
+  // Returns false if the program has no active block of that name.
+  bool bindUniformBlock(const char *name, GLuint binding);
 };
@@ -0,0 +1,3 @@
+#include "Asleep.h"
+
+Asleep::Asleep() = default;
@@ -1,3 +0,0 @@
-#include "ComponentType.h"
-
-size_t BaseComponentType::nextID = 0;
@@ -1,15 +1,66 @@
 #pragma once
 
 #include <stddef.h>
+#include <type_traits>
 
-class BaseComponentType {
-protected:
-  static size_t nextID;
+struct Acceleration;
+struct Asleep;
+struct Collidable;
+struct GravityAffected;
+struct Material;
+struct OnGround;
+struct PlayerControlled;
+struct Position;
+struct Renderable3D;
+struct Rotation;
+struct Scale;
+struct SleepState;
+struct Velocity;
+struct WorldAABB;
+
+template <typename... Ts> struct ComponentList {};
+
+// Every component type the ECS knows about. A component's ID is its position
+// in this list, so IDs (and therefore mask bits and pool slots) are fixed at
+// compile time and stable across builds. Only ever append to this list.
+using RegisteredComponents =
+    ComponentList<Position, Velocity, Acceleration, Rotation, Scale,
+                  Renderable3D, Material, Collidable, GravityAffected, OnGround,
+                  PlayerControlled, WorldAABB, SleepState, Asleep>;
+
+namespace detail {
+template <typename T, typename List> struct ComponentIndex;
+
+template <typename T> struct ComponentIndex<T, ComponentList<>> {
+  static_assert(!std::is_same_v<T, T>,
+                "Component type is not listed in RegisteredComponents");
+  static constexpr size_t value = 0;
+};
+
+template <typename T, typename... Rest>
+struct ComponentIndex<T, ComponentList<T, Rest...>> {
+  static constexpr size_t value = 0;
 };
 
-template <typename T> struct ComponentType : public BaseComponentType {
-  static size_t ID() {
-    static size_t id = nextID++;
-    return id;
+template <typename T, typename First, typename... Rest>
+struct ComponentIndex<T, ComponentList<First, Rest...>> {
+  static constexpr size_t value =
+      1 + ComponentIndex<T, ComponentList<Rest...>>::value;
+};
+
+template <typename List> struct ComponentCount;
+
+template <typename... Ts> struct ComponentCount<ComponentList<Ts...>> {
+  static constexpr size_t value = sizeof...(Ts);
+};
+} // namespace detail
+
+constexpr size_t REGISTERED_COMPONENT_COUNT =
+    detail::ComponentCount<RegisteredComponents>::value;
+
+template <typename T> struct ComponentType {
+  static constexpr size_t ID() {
+    return detail::ComponentIndex<std::remove_cv_t<T>,
+                                  RegisteredComponents>::value;
   }
 };
@@ -1,6 +1,6 @@
 #include "ModelLoader.h"
 
-bool ModelLoader::loadModel(const std::string &path, Renderable3D &renderable) {
+bool ModelLoader::loadModel(const std::string &path, Mesh &mesh) {
   Assimp::Importer importer;
   const aiScene *scene = importer.ReadFile(
       path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
@@ -12,36 +12,35 @@ bool ModelLoader::loadModel(const std::string &path, Renderable3D &renderable) {
   }
 
   if (scene->mNumMeshes > 0) {
-    aiMesh *mesh = scene->mMeshes[0];
-    processMesh(mesh, renderable);
+    processMesh(scene->mMeshes[0], mesh);
   }
 
   return true;
 }
 
-void ModelLoader::processMesh(aiMesh *mesh, Renderable3D &renderable) {
-  renderable.vertices.clear();
-  renderable.normals.clear();
-  renderable.indices.clear();
+void ModelLoader::processMesh(aiMesh *source, Mesh &mesh) {
+  mesh.vertices.clear();
+  mesh.normals.clear();
+  mesh.indices.clear();
 
   glm::vec3 minVertex(FLT_MAX);
   glm::vec3 maxVertex(-FLT_MAX);
 
-  for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+  for (unsigned int i = 0; i < source->mNumVertices; i++) {
     glm::vec3 vertex;
-    vertex.x = mesh->mVertices[i].x;
-    vertex.y = mesh->mVertices[i].y;
-    vertex.z = mesh->mVertices[i].z;
-    renderable.vertices.push_back(vertex);
+    vertex.x = source->mVertices[i].x;
+    vertex.y = source->mVertices[i].y;
+    vertex.z = source->mVertices[i].z;
+    mesh.vertices.push_back(vertex);
 
     minVertex = glm::min(minVertex, vertex);
     maxVertex = glm::max(maxVertex, vertex);
 
     glm::vec3 normal;
-    normal.x = mesh->mNormals[i].x;
-    normal.y = mesh->mNormals[i].y;
-    normal.z = mesh->mNormals[i].z;
-    renderable.normals.push_back(normal);
+    normal.x = source->mNormals[i].x;
+    normal.y = source->mNormals[i].y;
+    normal.z = source->mNormals[i].z;
+    mesh.normals.push_back(normal);
   }
 
   glm::vec3 center = (minVertex + maxVertex) * 0.5f;
@@ -53,18 +52,22 @@ void ModelLoader::processMesh(aiMesh *mesh, Renderable3D &renderable) {
   }
   float scaleFactor = 1.0f / maxComponent;
 
-  for (auto &vertex : renderable.vertices) {
+  for (auto &vertex : mesh.vertices) {
     vertex = (vertex - center) * scaleFactor;
   }
+  if (!mesh.vertices.empty()) {
+    mesh.bounds = AABB((minVertex - center) * scaleFactor,
+                       (maxVertex - center) * scaleFactor);
+  }
 
-  for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-    aiFace face = mesh->mFaces[i];
+  for (unsigned int i = 0; i < source->mNumFaces; i++) {
+    aiFace face = source->mFaces[i];
     for (unsigned int j = 0; j < face.mNumIndices; j++) {
-      renderable.indices.push_back(face.mIndices[j]);
+      mesh.indices.push_back(face.mIndices[j]);
     }
   }
 
   std::cout << "Model loaded and normalized successfully!" << std::endl;
-  std::cout << "Vertices loaded: " << renderable.vertices.size() << std::endl;
-  std::cout << "Indices loaded: " << renderable.indices.size() << std::endl;
+  std::cout << "Vertices loaded: " << mesh.vertices.size() << std::endl;
+  std::cout << "Indices loaded: " << mesh.indices.size() << std::endl;
 }
@@ -11,8 +11,8 @@
 
 class ModelLoader {
 public:
-  static bool loadModel(const std::string &path, Renderable3D &renderable);
+  static bool loadModel(const std::string &path, Mesh &mesh);
 
 private:
-  static void processMesh(aiMesh *mesh, Renderable3D &renderable);
+  static void processMesh(aiMesh *source, Mesh &mesh);
 };
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "../physics/AABB.h"
 #include "glad/glad.h"
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <vector>
 
@@ -16,12 +18,21 @@ struct Renderable2D {
                float g = 1.0f, float b = 1.0f);
 };
 
-struct Renderable3D {
+// Geometry of a model, loaded once and shared through the MeshRegistry
+struct Mesh {
   std::vector<glm::vec3> vertices;
   std::vector<glm::vec3> normals;
   std::vector<GLuint> indices;
+  // Bounds of the vertices in model space
+  AABB bounds;
+};
 
-  GLuint VAO, VBO, EBO;
+// Index of a mesh in the MeshRegistry
+using MeshHandle = uint32_t;
+const MeshHandle INVALID_MESH = ~MeshHandle(0);
+
+struct Renderable3D {
+  MeshHandle mesh;
 
-  Renderable3D();
+  Renderable3D(MeshHandle _mesh = INVALID_MESH);
 };
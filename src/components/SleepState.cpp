@@ -0,0 +1,3 @@
+#include "SleepState.h"
+
+SleepState::SleepState() : restTime(0.0f), island(INVALID_ENTITY) {}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "../core/Entity.h"
+
+// Lets a body fall asleep once it has been at rest for a while. Sleeping
+// bodies carry the Asleep tag and are skipped by PhysicsSystem until a
+// contact or input wakes them.
+struct SleepState {
+  // Seconds spent below the sleep velocity thresholds
+  float restTime;
+  // Island the body fell asleep with, INVALID_ENTITY while awake
+  EntityID island;
+
+  SleepState();
+};
@@ -0,0 +1,3 @@
+#include "WorldAABB.h"
+
+WorldAABB::WorldAABB(const AABB &initialBounds) : bounds(initialBounds) {}
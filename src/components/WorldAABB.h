@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../physics/AABB.h"
+
+// World-space bounds of a Collidable, derived from its Position, Scale and
+// Rotation; for rotated colliders it encloses the oriented box. Maintained
+// by PhysicsSystem: refreshed every step for bodies affected by gravity,
+// computed once for static colliders.
+struct WorldAABB {
+  AABB bounds;
+
+  WorldAABB(const AABB &initialBounds = AABB());
+};
@@ -1,30 +1,50 @@
 #include "Entity.h"
 
 EntityID EntityManager::createEntity() {
-  EntityID newEntity;
+  EntityIndex index;
   if (!availableEntities.empty()) {
-    // Reuse an old entity ID if available
-    newEntity = availableEntities.back();
+    // Reuse an old entity slot if available
+    index = availableEntities.back();
     availableEntities.pop_back();
   } else {
-    // Create a new entity ID
-    newEntity = componentMasks.size();
+    // Create a new entity slot
+    index = static_cast<EntityIndex>(componentMasks.size());
     componentMasks.push_back(
         ComponentMask()); // Default mask is empty (no components)
+    generations.push_back(0);
   }
-  return newEntity;
+  return makeEntityID(index, generations[index]);
 }
 
 void EntityManager::destroyEntity(EntityID entity) {
-  // Mark the entity as reusable by adding it to availableEntities
-  componentMasks[entity].reset();
-  availableEntities.push_back(entity);
+  if (!isAlive(entity)) {
+    return;
+  }
+
+  // Invalidate outstanding handles and mark the slot as reusable
+  EntityIndex index = entityIndex(entity);
+  componentMasks[index].reset();
+  ++generations[index];
+  availableEntities.push_back(index);
+}
+
+bool EntityManager::isAlive(EntityID entity) const {
+  EntityIndex index = entityIndex(entity);
+  return index < generations.size() &&
+         generations[index] == entityGeneration(entity);
 }
 
-// Return a non-const reference to allow modification
-ComponentMask &EntityManager::getComponentMask(EntityID entity) {
-  return componentMasks[entity];
+const ComponentMask &EntityManager::getComponentMask(EntityID entity) const {
+  static const ComponentMask noComponents;
+  return isAlive(entity) ? componentMasks[entityIndex(entity)] : noComponents;
+}
+
+void EntityManager::setComponentBit(EntityID entity, size_t componentID,
+                                    bool value) {
+  if (isAlive(entity)) {
+    componentMasks[entityIndex(entity)].set(componentID, value);
+  }
 }
 
-// This method returns the total number of entities that have been created
+// This method returns the total number of entity slots that have been created
 size_t EntityManager::entityCount() const { return componentMasks.size(); }
@@ -1,30 +1,59 @@
 #pragma once
 
 #include <bitset>
+#include <cstdint>
 #include <vector>
 
 // Maximum number of components an entity can have
 constexpr size_t MAX_COMPONENTS = 64;
 
-// Entity is represented by an ID
-using EntityID = size_t;
+// Entity is represented by a handle: the low 32 bits are the slot index and
+// the high 32 bits the generation of that slot. Destroying an entity bumps
+// the generation, so stale handles never alias a newer entity.
+using EntityID = uint64_t;
+using EntityIndex = uint32_t;
+using EntityGeneration = uint32_t;
 // Each entity has a bitmask for its components
 using ComponentMask = std::bitset<MAX_COMPONENTS>;
 
+constexpr EntityID INVALID_ENTITY = ~EntityID(0);
+
+constexpr EntityIndex entityIndex(EntityID entity) {
+  return static_cast<EntityIndex>(entity);
+}
+
+constexpr EntityGeneration entityGeneration(EntityID entity) {
+  return static_cast<EntityGeneration>(entity >> 32);
+}
+
+constexpr EntityID makeEntityID(EntityIndex index,
+                                EntityGeneration generation) {
+  return (static_cast<EntityID>(generation) << 32) | index;
+}
+
 class EntityManager {
 public:
   EntityID createEntity();
+  // Releases the entity's slot. Use ComponentManager::destroyEntity to also
+  // strip its components.
   void destroyEntity(EntityID entity);
+  // False once the entity has been destroyed, even if its slot was reused
+  bool isAlive(EntityID entity) const;
 
-  // Return a non-const reference so it can be modified
-  ComponentMask &getComponentMask(EntityID entity);
+  // Components of the entity; a stale handle has none
+  const ComponentMask &getComponentMask(EntityID entity) const;
+  // Sets or clears one component bit. Does nothing for stale handles, so
+  // they can't change the entity that reused their slot.
+  void setComponentBit(EntityID entity, size_t componentID, bool value);
 
-  // Method to return the count of entities
+  // Method to return the count of entity slots (alive or free)
   size_t entityCount() const;
 
 private:
-  // Stores bitmask for each entity
+  // Stores bitmask for each entity slot
   std::vector<ComponentMask> componentMasks;
-  // Reusable entity IDs
-  std::vector<EntityID> availableEntities;
+  // Current generation of each entity slot
+  std::vector<EntityGeneration> generations;
+  // Reusable entity slots
+  std::vector<EntityIndex> availableEntities;
 };
@@ -3,12 +3,12 @@
 #include "../components/Collidable.h"
 #include "../components/GravityAffected.h"
 #include "../components/Material.h"
-#include "../components/ModelLoader.h"
 #include "../components/PlayerControlled.h"
 #include "../components/Position.h"
 #include "../components/Renderable.h"
 #include "../components/Rotation.h"
 #include "../components/Scale.h"
+#include "../components/SleepState.h"
 #include "../components/Velocity.h"
 #include <cmath>
 #include <glm/glm.hpp>
@@ -59,25 +59,21 @@ glm::vec3 getNextPlatformPosition(const glm::vec3 &lastPos,
 
 // Helper function to initialize a platform
 void initializePlatform(EntityManager &entityManager,
-                        ComponentManager &componentManager, float x, float y,
-                        float z, float scaleX = 5.0f, float scaleY = 1.0f,
-                        float scaleZ = 5.0f) {
+                        ComponentManager &componentManager, MeshHandle mesh,
+                        float x, float y, float z, float scaleX = 5.0f,
+                        float scaleY = 1.0f, float scaleZ = 5.0f) {
   EntityID platform = entityManager.createEntity();
 
+  // Platforms never move: without Velocity, GravityAffected or SleepState
+  // they are static colliders that physics neither integrates nor tracks
   componentManager.addComponent(platform, Position(x, y, z), entityManager);
-  componentManager.addComponent(platform, Velocity(0.0f, 0.0f, 0.0f),
-                                entityManager);
-  componentManager.addComponent(platform, Acceleration(0.0f, 0.0f, 0.0f),
-                                entityManager);
 
-  // Load the 3D cube model for the platform
-  Renderable3D renderable3D;
-  ModelLoader::loadModel("assets/models/cube.obj", renderable3D);
-  componentManager.addComponent(platform, renderable3D, entityManager);
+  // Draw the platform with the shared cube mesh
+  componentManager.addComponent(platform, Renderable3D(mesh), entityManager);
 
   // Set the material color for the platform (grey)
-  Material platformMaterial(glm::vec3(0.8f, 0.8f, 0.8f), 0.5f, 32.0f);
-  componentManager.addComponent(platform, platformMaterial, entityManager);
+  componentManager.emplaceComponent<Material>(
+      platform, entityManager, glm::vec3(0.8f, 0.8f, 0.8f), 0.5f, 32.0f);
 
   // Add collidable tag for the platform
   componentManager.addComponent(platform, Collidable(), entityManager);
@@ -89,7 +85,7 @@ void initializePlatform(EntityManager &entityManager,
 
 // Function to initialize the player
 void initializePlayer(EntityManager &entityManager,
-                      ComponentManager &componentManager) {
+                      ComponentManager &componentManager, MeshHandle mesh) {
   EntityID player = entityManager.createEntity();
 
   componentManager.addComponent(player, Position(0.0f, 2.0f, 0.0f),
@@ -100,14 +96,12 @@ void initializePlayer(EntityManager &entityManager,
   componentManager.addComponent(player, Acceleration(0.0f, 0.0f, 0.0f),
                                 entityManager);
 
-  // Load the 3D cube model for the player
-  Renderable3D renderable3D;
-  ModelLoader::loadModel("assets/models/cube.obj", renderable3D);
-  componentManager.addComponent(player, renderable3D, entityManager);
+  // Draw the player with the shared cube mesh
+  componentManager.addComponent(player, Renderable3D(mesh), entityManager);
 
   // Set the material color for the player cube (orange)
-  Material playerMaterial(glm::vec3(1.0f, 0.5f, 0.0f), 0.5f, 32.0f);
-  componentManager.addComponent(player, playerMaterial, entityManager);
+  componentManager.emplaceComponent<Material>(
+      player, entityManager, glm::vec3(1.0f, 0.5f, 0.0f), 0.5f, 32.0f);
 
   // Add player-controlled tag
   componentManager.addComponent(player, PlayerControlled(), entityManager);
@@ -123,29 +117,36 @@ void initializePlayer(EntityManager &entityManager,
 
   // Add scale component to adjust the player's size if necessary
   componentManager.addComponent(player, Scale(1.0f, 1.0f, 1.0f), entityManager);
+
+  // Let the player sleep while idle, input wakes it up
+  componentManager.addComponent(player, SleepState(), entityManager);
 }
 } // unnamed namespace
 
 // Definition of initializeEntities
 void initializeEntities(EntityManager &entityManager,
-                        ComponentManager &componentManager) {
+                        ComponentManager &componentManager,
+                        MeshRegistry &meshRegistry) {
+  // Every entity is a cube; the model is only loaded the first time
+  MeshHandle cube = meshRegistry.load("assets/models/cube.obj");
+
   // Initialize the player-controlled red cube
-  initializePlayer(entityManager, componentManager);
+  initializePlayer(entityManager, componentManager, cube);
 
   // Initialize the starting platform
   glm::vec3 lastPlatformPos(0.0f, 0.0f, 0.0f); // Starting at the origin
   // Initial direction along the X-axis
   glm::vec3 lastDirection(1.0f, 0.0f, 0.0f);
 
-  initializePlatform(entityManager, componentManager, lastPlatformPos.x,
+  initializePlatform(entityManager, componentManager, cube, lastPlatformPos.x,
                      lastPlatformPos.y, lastPlatformPos.z, 10.0f, 1.0f, 10.0f);
 
   // Generate and initialize a path of platforms
   for (int i = 1; i <= PLATFORM_COUNT; ++i) {
     glm::vec3 nextPlatformPos =
         getNextPlatformPosition(lastPlatformPos, lastDirection);
-    initializePlatform(entityManager, componentManager, nextPlatformPos.x,
-                       nextPlatformPos.y, nextPlatformPos.z);
+    initializePlatform(entityManager, componentManager, cube,
+                       nextPlatformPos.x, nextPlatformPos.y, nextPlatformPos.z);
 
     // Update the last platform position and direction for the next iteration
     lastDirection = glm::normalize(nextPlatformPos - lastPlatformPos);
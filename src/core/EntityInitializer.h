@@ -2,6 +2,8 @@
 
 #include "../core/Entity.h"
 #include "../managers/ComponentManager.h"
+#include "../managers/MeshRegistry.h"
 
 void initializeEntities(EntityManager &entityManager,
-                        ComponentManager &componentManager);
+                        ComponentManager &componentManager,
+                        MeshRegistry &meshRegistry);
@@ -0,0 +1,156 @@
+#include "JobSystem.h"
+
+namespace {
+// Queue owned by the current thread; 0 for threads outside the pool
+thread_local const JobSystem *currentJobSystem = nullptr;
+thread_local size_t currentQueue = 0;
+} // unnamed namespace
+
+JobSystem::JobSystem(size_t workerCount) {
+  for (size_t i = 0; i <= workerCount; ++i) {
+    queues.push_back(std::make_unique<WorkQueue>());
+  }
+  for (size_t i = 1; i <= workerCount; ++i) {
+    workers.emplace_back(&JobSystem::workerLoop, this, i);
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+JobSystem::JobHandle
+JobSystem::schedule(Job job, const std::vector<JobHandle> &dependencies) {
+  auto state = std::make_shared<JobState>();
+  state->job = std::move(job);
+  state->pendingDependencies += dependencies.size();
+
+  for (const JobHandle &dependency : dependencies) {
+    std::lock_guard<std::mutex> lock(dependency.state->mutex);
+    if (dependency.state->finished) {
+      --state->pendingDependencies;
+    } else {
+      dependency.state->continuations.push_back(state);
+    }
+  }
+
+  // Drop the scheduling reference; queue the job if nothing is pending
+  if (--state->pendingDependencies == 0) {
+    enqueue(state);
+  }
+  return JobHandle{state};
+}
+
+void JobSystem::wait(const JobHandle &handle) {
+  size_t queueIndex = currentQueueIndex();
+  while (!isFinished(handle)) {
+    if (!runPendingJob(queueIndex)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool JobSystem::isFinished(const JobHandle &handle) const {
+  return !handle.state || handle.state->finished;
+}
+
+size_t JobSystem::workerCount() const { return workers.size(); }
+
+size_t JobSystem::defaultWorkerCount() {
+  size_t hardwareThreads = std::thread::hardware_concurrency();
+  return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+void JobSystem::workerLoop(size_t queueIndex) {
+  currentJobSystem = this;
+  currentQueue = queueIndex;
+
+  while (true) {
+    if (runPendingJob(queueIndex)) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wakeUp.wait(lock, [this]() { return stopping || queuedJobs > 0; });
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+void JobSystem::enqueue(std::shared_ptr<JobState> job) {
+  WorkQueue &queue = *queues[currentQueueIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+  }
+  {
+    // Publish under the sleep mutex so a worker can't miss the wake-up
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    ++queuedJobs;
+  }
+  wakeUp.notify_one();
+}
+
+std::shared_ptr<JobSystem::JobState> JobSystem::findJob(size_t queueIndex) {
+  {
+    // Own queue: newest first, its data is most likely still in cache
+    WorkQueue &own = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.jobs.empty()) {
+      auto job = std::move(own.jobs.back());
+      own.jobs.pop_back();
+      return job;
+    }
+  }
+
+  // Steal the oldest job from another queue
+  for (size_t offset = 1; offset < queues.size(); ++offset) {
+    WorkQueue &victim = *queues[(queueIndex + offset) % queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      auto job = std::move(victim.jobs.front());
+      victim.jobs.pop_front();
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+bool JobSystem::runPendingJob(size_t queueIndex) {
+  std::shared_ptr<JobState> job = findJob(queueIndex);
+  if (!job) {
+    return false;
+  }
+  --queuedJobs;
+  execute(job);
+  return true;
+}
+
+void JobSystem::execute(const std::shared_ptr<JobState> &job) {
+  job->job();
+
+  std::vector<std::shared_ptr<JobState>> ready;
+  {
+    std::lock_guard<std::mutex> lock(job->mutex);
+    job->finished = true;
+    ready.swap(job->continuations);
+  }
+
+  for (auto &continuation : ready) {
+    if (--continuation->pendingDependencies == 0) {
+      enqueue(std::move(continuation));
+    }
+  }
+}
+
+size_t JobSystem::currentQueueIndex() const {
+  return currentJobSystem == this ? currentQueue : 0;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops
+// its own jobs at the back and steals from the front of the others' when it
+// runs dry. Jobs may depend on other jobs, forming a task graph; a job is only
+// queued once all of its dependencies have finished.
+class JobSystem {
+public:
+  using Job = std::function<void()>;
+
+  struct JobState;
+  // Handle to a scheduled job, used for dependencies and waiting
+  struct JobHandle {
+    std::shared_ptr<JobState> state;
+  };
+
+  // Defaults to one worker per hardware thread, minus the calling thread
+  // which helps out while waiting
+  explicit JobSystem(size_t workerCount = defaultWorkerCount());
+  ~JobSystem();
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  // Schedules a job that runs after all of its dependencies have finished
+  JobHandle schedule(Job job, const std::vector<JobHandle> &dependencies = {});
+  // Blocks until the job has finished, running other jobs in the meantime
+  void wait(const JobHandle &handle);
+  bool isFinished(const JobHandle &handle) const;
+
+  // Splits [0, count) into ranges of at most grainSize and calls
+  // func(begin, end) for each range in parallel. Returns once all ranges
+  // are done. Without workers the whole of [0, count) is one range.
+  template <typename Func>
+  void parallelFor(size_t count, size_t grainSize, Func &&func);
+
+  size_t workerCount() const;
+
+  static size_t defaultWorkerCount();
+
+private:
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::shared_ptr<JobState>> jobs;
+  };
+
+  std::vector<std::thread> workers;
+  // One queue per worker plus one (index 0) for threads outside the pool
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  std::atomic<size_t> queuedJobs{0};
+  std::atomic<bool> stopping{false};
+  std::mutex sleepMutex;
+  std::condition_variable wakeUp;
+
+  void workerLoop(size_t queueIndex);
+  void enqueue(std::shared_ptr<JobState> job);
+  // Pops from the caller's own queue, or steals from another one
+  std::shared_ptr<JobState> findJob(size_t queueIndex);
+  bool runPendingJob(size_t queueIndex);
+  void execute(const std::shared_ptr<JobState> &job);
+  size_t currentQueueIndex() const;
+};
+
+struct JobSystem::JobState {
+  Job job;
+  // Unfinished dependencies, plus one held while the job is being scheduled
+  std::atomic<size_t> pendingDependencies{1};
+  std::atomic<bool> finished{false};
+  std::mutex mutex;
+  // Jobs waiting on this one
+  std::vector<std::shared_ptr<JobState>> continuations;
+};
+
+template <typename Func>
+void JobSystem::parallelFor(size_t count, size_t grainSize, Func &&func) {
+  if (count == 0) {
+    return;
+  }
+
+  grainSize = std::max<size_t>(grainSize, 1);
+  if (workers.empty() || count <= grainSize) {
+    func(size_t(0), count);
+    return;
+  }
+
+  std::vector<JobHandle> ranges;
+  ranges.reserve((count + grainSize - 1) / grainSize);
+  for (size_t begin = grainSize; begin < count; begin += grainSize) {
+    size_t end = std::min(begin + grainSize, count);
+    ranges.push_back(schedule([&func, begin, end]() { func(begin, end); }));
+  }
+
+  // The calling thread takes the first range itself
+  func(size_t(0), std::min(grainSize, count));
+
+  for (const JobHandle &range : ranges) {
+    wait(range);
+  }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../core/Entity.h"
+#include "../managers/CommandBuffer.h"
 #include <ComponentManager.h>
 #include <vector>
 
@@ -9,4 +10,45 @@ public:
   virtual void update(float deltaTime, EntityManager &entityManager,
                       ComponentManager &componentManager) = 0;
   virtual ~System() = default;
+
+  // Components this system reads and writes. The scheduler runs systems whose
+  // accesses don't conflict at the same time.
+  const ComponentMask &readMask() const { return reads; }
+  const ComponentMask &writeMask() const { return writes; }
+  bool conflictsWith(const System &other) const {
+    return (writes & (other.reads | other.writes)).any() ||
+           (other.writes & reads).any();
+  }
+
+  // Systems that use thread-affine state (e.g. the GL context) are only ever
+  // run on the thread that drives the scheduler
+  bool runsOnMainThread() const { return mainThreadOnly; }
+
+  // Applies the structural changes recorded during update. Must only be
+  // called while no system is running.
+  void playbackCommands(EntityManager &entityManager,
+                        ComponentManager &componentManager) {
+    commands.playback(entityManager, componentManager);
+  }
+
+  // Called at the sync point once every system has finished, for state that
+  // must not change while other systems run, e.g. handing over a frame
+  virtual void sync() {}
+
+protected:
+  // Structural changes are recorded here and applied at the next sync point
+  CommandBuffer commands;
+
+  template <typename... Ts> void readsComponents() {
+    (reads.set(ComponentType<Ts>::ID()), ...);
+  }
+  template <typename... Ts> void writesComponents() {
+    (writes.set(ComponentType<Ts>::ID()), ...);
+  }
+  void setRunsOnMainThread(bool mainThread) { mainThreadOnly = mainThread; }
+
+private:
+  ComponentMask reads;
+  ComponentMask writes;
+  bool mainThreadOnly = false;
 };
@@ -0,0 +1,62 @@
+#include "SystemScheduler.h"
+#include <algorithm>
+
+SystemScheduler::SystemScheduler(JobSystem &jobs) : jobSystem(&jobs) {}
+
+void SystemScheduler::addSystem(System &system) { systems.push_back(&system); }
+
+void SystemScheduler::run(float deltaTime, EntityManager &entityManager,
+                          ComponentManager &componentManager) {
+  handles.assign(systems.size(), JobSystem::JobHandle());
+
+  for (size_t i = 0; i < systems.size(); ++i) {
+    System *system = systems[i];
+
+    std::vector<JobSystem::JobHandle> dependencies;
+    for (size_t j = 0; j < i; ++j) {
+      if (system->conflictsWith(*systems[j]) && handles[j].state) {
+        dependencies.push_back(handles[j]);
+      }
+    }
+
+    if (system->runsOnMainThread()) {
+      // Run inline once its dependencies are done; the handle stays empty,
+      // which counts as finished for later systems
+      for (const auto &dependency : dependencies) {
+        jobSystem->wait(dependency);
+      }
+      system->update(deltaTime, entityManager, componentManager);
+      continue;
+    }
+
+    handles[i] = jobSystem->schedule(
+        [system, deltaTime, &entityManager, &componentManager]() {
+          system->update(deltaTime, entityManager, componentManager);
+        },
+        dependencies);
+  }
+
+  for (const auto &handle : handles) {
+    jobSystem->wait(handle);
+  }
+
+  // Sync point: apply structural changes in registration order
+  for (System *system : systems) {
+    system->playbackCommands(entityManager, componentManager);
+  }
+  for (System *system : systems) {
+    system->sync();
+  }
+}
+
+std::vector<size_t> SystemScheduler::levels() const {
+  std::vector<size_t> depths(systems.size(), 0);
+  for (size_t i = 0; i < systems.size(); ++i) {
+    for (size_t j = 0; j < i; ++j) {
+      if (systems[i]->conflictsWith(*systems[j])) {
+        depths[i] = std::max(depths[i], depths[j] + 1);
+      }
+    }
+  }
+  return depths;
+}
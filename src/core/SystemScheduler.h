@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../core/Entity.h"
+#include "../core/JobSystem.h"
+#include "../core/System.h"
+#include "../managers/ComponentManager.h"
+#include <vector>
+
+// Runs a set of systems on the job system. Every run builds a dependency graph
+// from the components each system declares it reads and writes: a system
+// waits for every earlier-registered system it conflicts with, everything
+// else runs concurrently. Main-thread systems run inline in registration
+// order, so register them after the systems they should overlap. Recorded
+// structural changes are applied once all systems have finished.
+class SystemScheduler {
+public:
+  explicit SystemScheduler(JobSystem &jobSystem);
+
+  // Registration order decides which of two conflicting systems runs first
+  void addSystem(System &system);
+
+  void run(float deltaTime, EntityManager &entityManager,
+           ComponentManager &componentManager);
+
+  // Depth of each system in the dependency graph, in registration order.
+  // Systems on the same level don't conflict and may run at the same time;
+  // each one waits only for conflicting systems on lower levels.
+  std::vector<size_t> levels() const;
+
+private:
+  JobSystem *jobSystem;
+  std::vector<System *> systems;
+  std::vector<JobSystem::JobHandle> handles;
+};
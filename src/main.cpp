@@ -1,22 +1,31 @@
 #include "./WindowConstants.h"
 #include "./core/Entity.h"
+#include "./core/JobSystem.h"
+#include "./core/SystemScheduler.h"
 #include "./managers/GameManager.h"
+#include "./managers/MeshRegistry.h"
 #include "./systems/InputSystem.h"
 #include "./systems/MovementSystem.h"
 #include "./systems/PhysicsSystem.h"
+#include "./systems/RenderExtractionSystem.h"
 #include "./systems/RenderSystem.h"
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <string>
 #include <vector>
 
-const float TARGET_FPS = 120.0f;
+const float TARGET_FPS = 60.0f;
 const float TARGET_FRAME_TIME = 1.0f / TARGET_FPS;
 const float RESET_THRESHOLD = -50.0f;
+// Seconds between updates of the render stats in the window title
+const float STATS_INTERVAL = 1.0f;
 
 GLFWwindow *window;
 EntityManager entityManager;
 ComponentManager componentManager;
+// Models shared by every entity that draws them, kept across game resets
+MeshRegistry meshRegistry;
 GameManager *gameManager;
 
 // Callback function to adjust the viewport when the window is resized
@@ -72,7 +81,28 @@ void cleanup() {
   glfwTerminate();
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  // Collision broadphase and component storage, picked with --broadphase
+  // and --storage
+  BroadphaseType broadphaseType = BroadphaseType::DynamicTree;
+  StorageMode storageMode = StorageMode::SparseSet;
+  for (int i = 1; i < argc; ++i) {
+    std::string option = argv[i];
+    if (option == "--broadphase" && i + 1 < argc &&
+        parseBroadphaseType(argv[++i], broadphaseType)) {
+      continue;
+    }
+    if (option == "--storage" && i + 1 < argc &&
+        parseStorageMode(argv[++i], storageMode)) {
+      continue;
+    }
+    std::cerr << "Usage: " << argv[0]
+              << " [--broadphase tree|grid|sap] [--storage sparse|archetype]"
+              << std::endl;
+    return -1;
+  }
+  componentManager = ComponentManager(storageMode);
+
   if (!initOpenGL()) {
     return -1;
   }
@@ -81,16 +111,34 @@ int main() {
   glfwSwapInterval(1);
 
   // Initialize game manager
-  gameManager = new GameManager(entityManager, componentManager);
+  gameManager = new GameManager(entityManager, componentManager, meshRegistry);
+
+  // Worker threads shared by all systems
+  JobSystem jobSystem;
 
   // Initialize systems
   InputSystem inputSystem;
   MovementSystem movementSystem(&inputSystem);
-  PhysicsSystem physicsSystem;
-  RenderSystem renderSystem(window);
+  PhysicsSystem physicsSystem(jobSystem, createBroadphase(broadphaseType));
+  RenderExtractionSystem renderExtractionSystem(jobSystem, meshRegistry,
+                                                &physicsSystem.getWorld());
+  RenderSystem renderSystem(renderExtractionSystem, meshRegistry);
+
+  // Fixed-step simulation systems, run concurrently where their declared
+  // component accesses allow it
+  SystemScheduler simulationScheduler(jobSystem);
+  simulationScheduler.addSystem(movementSystem);
+  simulationScheduler.addSystem(physicsSystem);
+
+  // Per-frame systems: the next frame is extracted on a worker while the
+  // main thread draws the one extracted last frame
+  SystemScheduler frameScheduler(jobSystem);
+  frameScheduler.addSystem(renderExtractionSystem);
+  frameScheduler.addSystem(renderSystem);
 
   float lastTime = glfwGetTime();
   float accumulator = 0.0f;
+  float lastStatsTime = lastTime;
 
   // Main game loop
   while (!glfwWindowShouldClose(window)) {
@@ -104,41 +152,52 @@ int main() {
 
     // Game logic update
     while (accumulator >= TARGET_FRAME_TIME) {
-      movementSystem.update(TARGET_FRAME_TIME, entityManager, componentManager);
-      physicsSystem.update(TARGET_FRAME_TIME, entityManager, componentManager);
+      simulationScheduler.run(TARGET_FRAME_TIME, entityManager,
+                              componentManager);
       accumulator -= TARGET_FRAME_TIME;
     }
 
     // Check if the player has fallen below the reset threshold
     // Find the player entity
     Position *playerPosition = nullptr;
-    for (EntityID entity = 0; entity < entityManager.entityCount(); ++entity) {
-      const ComponentMask &mask = entityManager.getComponentMask(entity);
-      if (mask.test(ComponentType<PlayerControlled>::ID()) &&
-          mask.test(ComponentType<Position>::ID())) {
-        playerPosition = componentManager.getComponent<Position>(entity);
-        break;
-      }
-    }
+    componentManager.view<PlayerControlled, Position>(entityManager)
+        .each([&](EntityID, PlayerControlled &, Position &position) {
+          playerPosition = &position;
+        });
 
     // Render the scene
-    renderSystem.update(deltaTime, entityManager, componentManager);
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    renderExtractionSystem.setViewport(width, height);
+    frameScheduler.run(deltaTime, entityManager, componentManager);
 
     // Swap the buffers (show the rendered frame)
     glfwSwapBuffers(window);
 
+    // Report how much of the scene the frustum culling skipped
+    if (currentTime - lastStatsTime >= STATS_INTERVAL) {
+      const RenderStats &stats = renderSystem.getStats();
+      std::string title = "CloudFire - " + std::to_string(stats.visible) +
+                          " visible, " + std::to_string(stats.culled) +
+                          " culled";
+      glfwSetWindowTitle(window, title.c_str());
+      lastStatsTime = currentTime;
+    }
+
     if (playerPosition && playerPosition->y < RESET_THRESHOLD) {
       gameManager->resetGame();
       std::cout << "Player fell below threshold. Game reset." << std::endl;
       inputSystem = InputSystem();
       movementSystem = MovementSystem(&inputSystem);
-      physicsSystem = PhysicsSystem();
+      physicsSystem =
+          PhysicsSystem(jobSystem, createBroadphase(broadphaseType));
       // render system needs to call reset method because it has OpenGL
       // resources that need to be cleaned up. In hindsight, I could've used
       // operator overloading to make this more readable
       renderSystem.reset();
       // Reset timing variables
       lastTime = glfwGetTime();
+      lastStatsTime = lastTime;
       accumulator = 0.0f;
     }
   }
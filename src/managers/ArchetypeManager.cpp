@@ -0,0 +1,174 @@
+#include "ArchetypeManager.h"
+#include <algorithm>
+
+namespace {
+size_t alignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // unnamed namespace
+
+Archetype::Archetype(
+    const ComponentMask &mask,
+    const std::array<const ComponentInfo *, MAX_COMPONENTS> &infos)
+    : componentMask(mask) {
+  columnOffsets.fill(NO_COLUMN);
+
+  size_t rowBytes = sizeof(EntityID);
+  for (size_t id = 0; id < MAX_COMPONENTS; ++id) {
+    if (mask.test(id)) {
+      columnIDs.push_back(id);
+      columnInfos[id] = infos[id];
+      rowBytes += infos[id]->size;
+    }
+  }
+
+  // Fit as many rows as possible in a chunk, leaving room for column padding
+  size_t padding = ARCHETYPE_CHUNK_ALIGNMENT * (columnIDs.size() + 1);
+  capacity = ARCHETYPE_CHUNK_SIZE > padding
+                 ? (ARCHETYPE_CHUNK_SIZE - padding) / rowBytes
+                 : 0;
+  capacity = std::max<size_t>(capacity, 1);
+
+  // Lay out the entity column first, then each component column
+  size_t offset =
+      alignUp(capacity * sizeof(EntityID), ARCHETYPE_CHUNK_ALIGNMENT);
+  for (size_t id : columnIDs) {
+    offset = alignUp(offset, std::max(columnInfos[id]->alignment,
+                                      ARCHETYPE_CHUNK_ALIGNMENT));
+    columnOffsets[id] = offset;
+    offset += capacity * columnInfos[id]->size;
+  }
+  chunkBytes = alignUp(offset, ARCHETYPE_CHUNK_ALIGNMENT);
+}
+
+Archetype::~Archetype() {
+  for (size_t row = 0; row < rowCount; ++row) {
+    for (size_t id : columnIDs) {
+      columnInfos[id]->destroy(component(id, row));
+    }
+  }
+}
+
+const ComponentMask &Archetype::mask() const { return componentMask; }
+
+bool Archetype::hasColumn(size_t componentID) const {
+  return columnOffsets[componentID] != NO_COLUMN;
+}
+
+size_t Archetype::size() const { return rowCount; }
+
+size_t Archetype::chunkCount() const { return chunks.size(); }
+
+size_t Archetype::chunkCapacity() const { return capacity; }
+
+size_t Archetype::chunkSize(size_t chunk) const { return chunks[chunk].count; }
+
+size_t Archetype::allocateRow(EntityID entity) {
+  if (chunks.empty() || chunks.back().count == capacity) {
+    ArchetypeChunk chunk;
+    chunk.storage.reset(static_cast<std::byte *>(::operator new(
+        chunkBytes, std::align_val_t(ARCHETYPE_CHUNK_ALIGNMENT))));
+    chunks.push_back(std::move(chunk));
+  }
+
+  ArchetypeChunk &chunk = chunks.back();
+  entities(chunks.size() - 1)[chunk.count] = entity;
+  ++chunk.count;
+  return rowCount++;
+}
+
+EntityID Archetype::removeRow(size_t row) {
+  size_t last = rowCount - 1;
+  EntityID removed = entity(row);
+  EntityID moved = entity(last);
+
+  for (size_t id : columnIDs) {
+    columnInfos[id]->destroy(component(id, row));
+    if (row != last) {
+      // Fill the hole with the last row to keep the chunks packed
+      columnInfos[id]->moveConstruct(component(id, row), component(id, last));
+      columnInfos[id]->destroy(component(id, last));
+    }
+  }
+  entities(row / capacity)[row % capacity] = moved;
+
+  --rowCount;
+  if (--chunks.back().count == 0) {
+    chunks.pop_back();
+  }
+  return row != last ? moved : removed;
+}
+
+EntityID Archetype::entity(size_t row) {
+  return entities(row / capacity)[row % capacity];
+}
+
+EntityID *Archetype::entities(size_t chunk) {
+  return reinterpret_cast<EntityID *>(chunks[chunk].storage.get());
+}
+
+void *Archetype::column(size_t componentID, size_t chunk) {
+  return chunks[chunk].storage.get() + columnOffsets[componentID];
+}
+
+void *Archetype::component(size_t componentID, size_t row) {
+  return static_cast<std::byte *>(column(componentID, row / capacity)) +
+         (row % capacity) * columnInfos[componentID]->size;
+}
+
+void ArchetypeManager::destroyEntity(EntityID entity,
+                                     EntityManager &entityManager) {
+  if (!entityManager.isAlive(entity)) {
+    return;
+  }
+
+  EntityLocation &current = location(entity);
+  if (current.archetype) {
+    EntityID moved = current.archetype->removeRow(current.row);
+    location(moved).row = current.row;
+    current = EntityLocation();
+  }
+  entityManager.destroyEntity(entity);
+}
+
+size_t ArchetypeManager::archetypeCount() const { return archetypes.size(); }
+
+ArchetypeManager::EntityLocation &ArchetypeManager::location(EntityID entity) {
+  EntityIndex index = entityIndex(entity);
+  if (index >= locations.size()) {
+    locations.resize(index + 1);
+  }
+  return locations[index];
+}
+
+Archetype &ArchetypeManager::getArchetype(const ComponentMask &mask) {
+  Archetype *&archetype = archetypeByMask[mask];
+  if (!archetype) {
+    archetypes.push_back(std::make_unique<Archetype>(mask, componentInfos));
+    archetype = archetypes.back().get();
+  }
+  return *archetype;
+}
+
+size_t ArchetypeManager::moveEntity(EntityID entity, Archetype &target) {
+  EntityLocation &current = location(entity);
+  size_t row = target.allocateRow(entity);
+
+  if (current.archetype) {
+    Archetype &source = *current.archetype;
+    for (size_t id = 0; id < MAX_COMPONENTS; ++id) {
+      if (source.hasColumn(id) && target.hasColumn(id)) {
+        componentInfos[id]->moveConstruct(target.component(id, row),
+                                          source.component(id, current.row));
+      }
+    }
+
+    // Destroys the moved-from components and any the target doesn't have
+    EntityID moved = source.removeRow(current.row);
+    location(moved).row = current.row;
+  }
+
+  current.archetype = &target;
+  current.row = row;
+  return row;
+}
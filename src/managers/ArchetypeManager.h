@@ -0,0 +1,222 @@
+#pragma once
+
+#include "../components/ComponentType.h"
+#include "../core/Entity.h"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Target size of a single archetype chunk in bytes
+constexpr size_t ARCHETYPE_CHUNK_SIZE = 16 * 1024;
+// Alignment of chunk storage, one cache line
+constexpr size_t ARCHETYPE_CHUNK_ALIGNMENT = 64;
+
+// Type-erased description of a component so archetypes can relocate rows
+// without knowing the concrete component types
+struct ComponentInfo {
+  size_t size;
+  size_t alignment;
+  void (*moveConstruct)(void *destination, void *source);
+  void (*destroy)(void *component);
+};
+
+template <typename T> const ComponentInfo &componentInfo() {
+  static const ComponentInfo info = {
+      sizeof(T), alignof(T),
+      [](void *destination, void *source) {
+        new (destination) T(std::move(*static_cast<T *>(source)));
+      },
+      [](void *component) { static_cast<T *>(component)->~T(); }};
+  return info;
+}
+
+// Fixed-size block of SoA storage: an entity column followed by one column
+// per component of the owning archetype
+struct ArchetypeChunk {
+  struct AlignedDelete {
+    void operator()(std::byte *storage) const {
+      ::operator delete(storage, std::align_val_t(ARCHETYPE_CHUNK_ALIGNMENT));
+    }
+  };
+
+  std::unique_ptr<std::byte, AlignedDelete> storage;
+  size_t count = 0;
+};
+
+// All entities sharing exactly the same set of data components. Rows are
+// kept packed: every chunk except the last one is full.
+class Archetype {
+public:
+  Archetype(const ComponentMask &mask,
+            const std::array<const ComponentInfo *, MAX_COMPONENTS> &infos);
+  ~Archetype();
+
+  Archetype(const Archetype &) = delete;
+  Archetype &operator=(const Archetype &) = delete;
+
+  const ComponentMask &mask() const;
+  bool hasColumn(size_t componentID) const;
+
+  // Number of rows across all chunks
+  size_t size() const;
+  size_t chunkCount() const;
+  size_t chunkCapacity() const;
+  size_t chunkSize(size_t chunk) const;
+
+  // Appends a row for the entity. Component storage is left uninitialized.
+  size_t allocateRow(EntityID entity);
+  // Destroys the row's components and moves the last row into the hole.
+  // Returns the entity that now occupies the row, or the removed entity if
+  // the row was the last one.
+  EntityID removeRow(size_t row);
+
+  EntityID entity(size_t row);
+  EntityID *entities(size_t chunk);
+  void *column(size_t componentID, size_t chunk);
+  void *component(size_t componentID, size_t row);
+
+private:
+  static constexpr size_t NO_COLUMN = static_cast<size_t>(-1);
+
+  ComponentMask componentMask;
+  std::vector<size_t> columnIDs;
+  std::array<const ComponentInfo *, MAX_COMPONENTS> columnInfos{};
+  // Byte offset of each component column inside a chunk
+  std::array<size_t, MAX_COMPONENTS> columnOffsets;
+  size_t capacity;
+  size_t chunkBytes;
+  size_t rowCount = 0;
+  std::vector<ArchetypeChunk> chunks;
+};
+
+// Archetype storage backend of the ComponentManager. Entities with the same
+// data components share an Archetype and their components are streamed chunk
+// by chunk, so views only touch matching archetypes. Tags never reach it,
+// they stay ComponentMask bits. The EntityManager masks are kept in sync.
+class ArchetypeManager {
+public:
+  // Adding or removing components of a destroyed entity does nothing;
+  // emplaceComponent returns null for it
+  template <typename T, typename... Args>
+  T *emplaceComponent(EntityID entity, EntityManager &entityManager,
+                      Args &&...args);
+  template <typename T>
+  void removeComponent(EntityID entity, EntityManager &entityManager);
+  template <typename T> T *getComponent(EntityID entity);
+
+  // Removes all of the entity's components and destroys it
+  void destroyEntity(EntityID entity, EntityManager &entityManager);
+
+  // Calls func(Archetype &, chunk) for every chunk of the archetypes that
+  // have all of required and none of excluded, in archetype creation order
+  template <typename Func>
+  void eachChunk(const ComponentMask &required, const ComponentMask &excluded,
+                 Func &&func);
+
+  size_t archetypeCount() const;
+
+private:
+  struct EntityLocation {
+    Archetype *archetype = nullptr;
+    size_t row = 0;
+  };
+
+  std::array<const ComponentInfo *, MAX_COMPONENTS> componentInfos{};
+  // Archetypes in creation order, so iteration order doesn't depend on
+  // hashing
+  std::vector<std::unique_ptr<Archetype>> archetypes;
+  std::unordered_map<ComponentMask, Archetype *> archetypeByMask;
+  std::vector<EntityLocation> locations;
+
+  EntityLocation &location(EntityID entity);
+  Archetype &getArchetype(const ComponentMask &mask);
+  // Moves the entity's shared components into the target archetype and
+  // returns its new row
+  size_t moveEntity(EntityID entity, Archetype &target);
+};
+
+template <typename T, typename... Args>
+T *ArchetypeManager::emplaceComponent(EntityID entity,
+                                      EntityManager &entityManager,
+                                      Args &&...args) {
+  static_assert(!std::is_empty_v<T>,
+                "Tag components are ComponentMask bits, not archetype columns");
+  if (!entityManager.isAlive(entity)) {
+    return nullptr;
+  }
+
+  size_t componentID = ComponentType<T>::ID();
+  componentInfos[componentID] = &componentInfo<T>();
+
+  if (T *existing = getComponent<T>(entity)) {
+    // Already present, overwrite in place
+    *existing = T(std::forward<Args>(args)...);
+    return existing;
+  }
+
+  EntityLocation &current = location(entity);
+  ComponentMask targetMask =
+      current.archetype ? current.archetype->mask() : ComponentMask();
+  targetMask.set(componentID);
+  Archetype &target = getArchetype(targetMask);
+  size_t row = moveEntity(entity, target);
+  entityManager.setComponentBit(entity, componentID, true);
+
+  return new (target.component(componentID, row))
+      T(std::forward<Args>(args)...);
+}
+
+template <typename T>
+void ArchetypeManager::removeComponent(EntityID entity,
+                                       EntityManager &entityManager) {
+  size_t componentID = ComponentType<T>::ID();
+  if (!entityManager.isAlive(entity) || !getComponent<T>(entity)) {
+    return;
+  }
+
+  EntityLocation &current = location(entity);
+  ComponentMask targetMask = current.archetype->mask();
+  targetMask.reset(componentID);
+  if (targetMask.none()) {
+    EntityID moved = current.archetype->removeRow(current.row);
+    location(moved).row = current.row;
+    current = EntityLocation();
+  } else {
+    moveEntity(entity, getArchetype(targetMask));
+  }
+  entityManager.setComponentBit(entity, componentID, false);
+}
+
+template <typename T> T *ArchetypeManager::getComponent(EntityID entity) {
+  size_t componentID = ComponentType<T>::ID();
+  if (entityIndex(entity) >= locations.size()) {
+    return nullptr;
+  }
+  // The row's entity check rejects stale handles to a reused slot
+  const EntityLocation &current = locations[entityIndex(entity)];
+  if (!current.archetype || !current.archetype->hasColumn(componentID) ||
+      current.archetype->entity(current.row) != entity) {
+    return nullptr;
+  }
+  return static_cast<T *>(
+      current.archetype->component(componentID, current.row));
+}
+
+template <typename Func>
+void ArchetypeManager::eachChunk(const ComponentMask &required,
+                                 const ComponentMask &excluded, Func &&func) {
+  for (const auto &archetype : archetypes) {
+    const ComponentMask &mask = archetype->mask();
+    if ((mask & required) != required || (mask & excluded).any()) {
+      continue;
+    }
+    for (size_t chunk = 0; chunk < archetype->chunkCount(); ++chunk) {
+      func(*archetype, chunk);
+    }
+  }
+}
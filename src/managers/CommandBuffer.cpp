@@ -0,0 +1,60 @@
+#include "CommandBuffer.h"
+
+EntityID CommandBuffer::createEntity() {
+  // The entity itself is created at the start of playback
+  return makeEntityID(pendingEntityCount++, PENDING_GENERATION);
+}
+
+void CommandBuffer::destroyEntity(EntityID entity) {
+  commands.push_back([entity](EntityManager &entityManager,
+                              ComponentManager &componentManager,
+                              const std::vector<EntityID> &createdEntities) {
+    componentManager.destroyEntity(resolve(entity, createdEntities),
+                                   entityManager);
+  });
+}
+
+void CommandBuffer::playback(EntityManager &entityManager,
+                             ComponentManager &componentManager) {
+  if (empty()) {
+    return;
+  }
+
+  // Grow each pool once for the whole batch
+  for (size_t id = 0; id < MAX_COMPONENTS; ++id) {
+    if (pendingAdditions[id] > 0) {
+      componentManager.reserve(id, pendingAdditions[id]);
+    }
+  }
+
+  // Create every pending entity up front so any command can refer to them
+  std::vector<EntityID> createdEntities;
+  createdEntities.reserve(pendingEntityCount);
+  for (EntityIndex i = 0; i < pendingEntityCount; ++i) {
+    createdEntities.push_back(entityManager.createEntity());
+  }
+
+  for (auto &command : commands) {
+    command(entityManager, componentManager, createdEntities);
+  }
+
+  commands.clear();
+  pendingEntityCount = 0;
+  pendingAdditions.fill(0);
+}
+
+bool CommandBuffer::empty() const {
+  return commands.empty() && pendingEntityCount == 0;
+}
+
+EntityID CommandBuffer::resolve(EntityID entity,
+                                const std::vector<EntityID> &createdEntities) {
+  if (entityGeneration(entity) != PENDING_GENERATION) {
+    return entity;
+  }
+  // Placeholders of another buffer, or from before the last playback, don't
+  // name anything this playback created
+  EntityIndex index = entityIndex(entity);
+  return index < createdEntities.size() ? createdEntities[index]
+                                        : INVALID_ENTITY;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../core/Entity.h"
+#include "./ComponentManager.h"
+#include <array>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Records structural changes (entity creation/destruction, component
+// addition/removal) while systems iterate, and applies them in one batch at a
+// sync point so pools and masks never change under a running view.
+class CommandBuffer {
+public:
+  // Reserves an entity that is created on playback. The returned placeholder
+  // can be passed to the other commands of this buffer.
+  EntityID createEntity();
+  void destroyEntity(EntityID entity);
+  template <typename T> void addComponent(EntityID entity, T component);
+  template <typename T> void removeComponent(EntityID entity);
+
+  // Applies every recorded command in recording order, then clears the buffer
+  void playback(EntityManager &entityManager,
+                ComponentManager &componentManager);
+
+  bool empty() const;
+
+private:
+  // Placeholder entities use a generation live entities never reach
+  static constexpr EntityGeneration PENDING_GENERATION = ~EntityGeneration(0);
+
+  using Command = std::function<void(EntityManager &, ComponentManager &,
+                                     const std::vector<EntityID> &)>;
+
+  std::vector<Command> commands;
+  EntityIndex pendingEntityCount = 0;
+  // Number of pending additions per component ID, used to grow pools once
+  std::array<size_t, MAX_COMPONENTS> pendingAdditions{};
+
+  // Maps a placeholder to the entity created for it during playback, or to
+  // INVALID_ENTITY if this playback created none for it
+  static EntityID resolve(EntityID entity,
+                          const std::vector<EntityID> &createdEntities);
+};
+
+template <typename T>
+void CommandBuffer::addComponent(EntityID entity, T component) {
+  ++pendingAdditions[ComponentType<T>::ID()];
+  commands.push_back([entity, component = std::move(component)](
+                         EntityManager &entityManager,
+                         ComponentManager &componentManager,
+                         const std::vector<EntityID> &createdEntities) mutable {
+    EntityID target = resolve(entity, createdEntities);
+    if (entityManager.isAlive(target)) {
+      componentManager.addComponent(target, std::move(component),
+                                    entityManager);
+    }
+  });
+}
+
+template <typename T> void CommandBuffer::removeComponent(EntityID entity) {
+  commands.push_back([entity](EntityManager &entityManager,
+                              ComponentManager &componentManager,
+                              const std::vector<EntityID> &createdEntities) {
+    EntityID target = resolve(entity, createdEntities);
+    if (entityManager.isAlive(target)) {
+      componentManager.removeComponent<T>(target, entityManager);
+    }
+  });
+}
@@ -1,78 +1,556 @@
 #pragma once
 
 #include "../components/Acceleration.h"
+#include "../components/Asleep.h"
+#include "../components/Collidable.h"
 #include "../components/ComponentType.h"
+#include "../components/GravityAffected.h"
+#include "../components/Material.h"
+#include "../components/OnGround.h"
+#include "../components/PlayerControlled.h"
 #include "../components/Position.h"
 #include "../components/Renderable.h"
+#include "../components/Rotation.h"
+#include "../components/Scale.h"
+#include "../components/SleepState.h"
 #include "../components/Velocity.h"
+#include "../components/WorldAABB.h"
 #include "../core/Entity.h"
+#include "../core/JobSystem.h"
+#include "./ArchetypeManager.h"
+#include <array>
 #include <memory>
-#include <typeindex>
-#include <unordered_map>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-using EntityID = size_t;
+static_assert(REGISTERED_COMPONENT_COUNT <= MAX_COMPONENTS,
+              "Too many registered components for ComponentMask");
 
-template <typename T> class ComponentPool {
+// Empty components (Collidable, OnGround, ...) are tags: they only exist as a
+// ComponentMask bit and never get a pool, so toggling one never allocates
+template <typename T> constexpr bool isTagComponent = std::is_empty_v<T>;
+
+// Shared instance handed out wherever a reference to a tag is required
+template <typename T> T &tagComponent() {
+  static T instance;
+  return instance;
+}
+
+// Type-erased pool interface so an entity can be stripped from every pool
+class BaseComponentPool {
+public:
+  virtual ~BaseComponentPool() = default;
+  virtual void removeComponent(EntityID entity) = 0;
+  // Grows capacity for `additional` more components
+  virtual void reserve(size_t additional) = 0;
+};
+
+// Sparse-set storage: components are packed contiguously and indexed through
+// a sparse entity index -> slot table, so lookups never hash and iteration is
+// linear
+template <typename T> class ComponentPool : public BaseComponentPool {
 public:
-  T &addComponent(EntityID entity, T component);
-  void removeComponent(EntityID entity);
+  T *addComponent(EntityID entity, const T &component);
+  T *addComponent(EntityID entity, T &&component);
+  // Constructs the component in place with a single sparse lookup. Returns
+  // null if the slot holds the component of another generation of the
+  // entity, which a stale handle must not overwrite.
+  template <typename... Args> T *emplace(EntityID entity, Args &&...args);
+  void removeComponent(EntityID entity) override;
+  void reserve(size_t additional) override;
   T *getComponent(EntityID entity);
+  bool hasComponent(EntityID entity) const;
+
+  // Number of packed components
+  size_t size() const;
+  // Packed component data, index-aligned with entities()
+  std::vector<T> &data();
+  const std::vector<EntityID> &entities() const;
 
 private:
-  std::unordered_map<EntityID, T> components;
+  static constexpr size_t INVALID_SLOT = static_cast<size_t>(-1);
+
+  // Packed component data
+  std::vector<T> components;
+  // Entity owning each packed component
+  std::vector<EntityID> denseEntities;
+  // Entity index -> index into components (INVALID_SLOT if absent)
+  std::vector<size_t> sparse;
 };
 
+template <typename... Ts> class ComponentView;
+
+// Where a ComponentManager keeps component data. Tags are ComponentMask bits
+// in both.
+enum class StorageMode {
+  // One packed pool per component type
+  SparseSet,
+  // Entities with the same components share 16 KB SoA chunks (see
+  // ArchetypeManager). Views only visit matching chunks, but adding or
+  // removing a data component moves the entity's row.
+  Archetype,
+};
+
+// "sparse" or "archetype". Leaves mode untouched and returns false for other
+// names.
+inline bool parseStorageMode(const std::string &name, StorageMode &mode) {
+  if (name == "sparse") {
+    mode = StorageMode::SparseSet;
+  } else if (name == "archetype") {
+    mode = StorageMode::Archetype;
+  } else {
+    return false;
+  }
+  return true;
+}
+
 class ComponentManager {
 public:
+  explicit ComponentManager(StorageMode mode = StorageMode::SparseSet);
+
+  StorageMode storageMode() const;
+
+  // Adding or removing components of a destroyed entity does nothing; the
+  // add functions return null for it
   template <typename T>
-  T &addComponent(EntityID entity, T component, EntityManager &entityManager);
-  template <typename T> void removeComponent(EntityID entity);
+  std::decay_t<T> *addComponent(EntityID entity, T &&component,
+                                EntityManager &entityManager);
+  // Constructs the component in place from args
+  template <typename T, typename... Args>
+  T *emplaceComponent(EntityID entity, EntityManager &entityManager,
+                      Args &&...args);
+  template <typename T>
+  void removeComponent(EntityID entity, EntityManager &entityManager);
   template <typename T> T *getComponent(EntityID entity);
 
+  // Strips the entity's components from every pool and destroys it
+  void destroyEntity(EntityID entity, EntityManager &entityManager);
+
+  // Grows a pool ahead of a batch of additions. Archetype storage grows a
+  // chunk at a time and ignores it.
+  void reserve(size_t componentID, size_t additional);
+
+  // Query every entity that has all of Ts
+  template <typename... Ts>
+  ComponentView<Ts...> view(EntityManager &entityManager);
+
 private:
-  std::unordered_map<std::type_index, std::shared_ptr<void>> componentPools;
+  StorageMode mode;
+  // One pool per registered non-tag component, indexed by
+  // ComponentType<T>::ID() (null for tags, and all null in archetype storage)
+  std::array<std::unique_ptr<BaseComponentPool>, MAX_COMPONENTS>
+      componentPools;
+  // Only set in archetype storage
+  std::unique_ptr<ArchetypeManager> archetypes;
 
+  template <typename... Ts> void createPools(ComponentList<Ts...>);
   template <typename T> ComponentPool<T> &getComponentPool();
+  // Null for tag components
+  template <typename T> ComponentPool<T> *findComponentPool();
+};
+
+// Iterates the entities that have every component in Ts. Over pools,
+// iteration is driven by the smallest pool, the rest are matched through the
+// entity masks and resolved with a sparse lookup. Over archetypes, it streams
+// the chunks of the matching archetypes. Tags are matched by mask only, so
+// at least one of Ts must carry data.
+template <typename... Ts> class ComponentView {
+public:
+  ComponentView(ComponentPool<Ts> *...pools, EntityManager &entityManager);
+  ComponentView(ArchetypeManager &archetypes, EntityManager &entityManager);
+
+  // Skips entities that have any of Us, e.g. view<Position>().exclude<Asleep>()
+  template <typename... Us> ComponentView &exclude();
+
+  // Calls func(EntityID, Ts &...) for every matching entity. Over pools,
+  // removing the current entity's components from within func is safe; over
+  // archetypes only tags may change, record other structural changes in a
+  // CommandBuffer.
+  template <typename Func> void each(Func &&func);
+  // Same as each, but splits the entities into ranges of grainSize (a chunk
+  // each over archetypes) that run in parallel on the job system. func must
+  // only touch the entity it is given; record structural changes in a
+  // CommandBuffer per range instead.
+  template <typename Func>
+  void parallelEach(JobSystem &jobSystem, size_t grainSize, Func &&func);
+
+private:
+  struct ChunkRef {
+    Archetype *archetype;
+    size_t chunk;
+  };
+
+  std::tuple<ComponentPool<Ts> *...> pools;
+  // Null when iterating pools
+  ArchetypeManager *archetypes = nullptr;
+  EntityManager &entityManager;
+  ComponentMask requiredMask;
+  ComponentMask excludedMask;
+  // Required and excluded tags, which archetypes don't hold
+  ComponentMask tagMask;
+
+  bool matches(EntityID entity);
+  const std::vector<EntityID> &smallestPoolEntities() const;
+  template <typename T> T &component(EntityID entity);
+  // Calls func for the matching entities of one archetype chunk
+  template <typename Func> void eachInChunk(const ChunkRef &ref, Func &func);
+  template <typename T>
+  static T *chunkColumn(Archetype &archetype, size_t chunk);
+  template <typename T> static T &chunkRow(T *column, size_t row);
 };
 
 template <typename T>
-T &ComponentPool<T>::addComponent(EntityID entity, T component) {
-  components[entity] = component;
-  return components[entity];
+T *ComponentPool<T>::addComponent(EntityID entity, const T &component) {
+  return emplace(entity, component);
+}
+
+template <typename T>
+T *ComponentPool<T>::addComponent(EntityID entity, T &&component) {
+  return emplace(entity, std::move(component));
+}
+
+template <typename T>
+template <typename... Args>
+T *ComponentPool<T>::emplace(EntityID entity, Args &&...args) {
+  EntityIndex index = entityIndex(entity);
+  if (index >= sparse.size()) {
+    sparse.resize(index + 1, INVALID_SLOT);
+  }
+
+  size_t &slot = sparse[index];
+  if (slot != INVALID_SLOT) {
+    if (denseEntities[slot] != entity) {
+      return nullptr;
+    }
+    // Entity already has this component, overwrite it
+    components[slot] = T(std::forward<Args>(args)...);
+    return &components[slot];
+  }
+
+  slot = components.size();
+  denseEntities.push_back(entity);
+  return &components.emplace_back(std::forward<Args>(args)...);
 }
 
 template <typename T> void ComponentPool<T>::removeComponent(EntityID entity) {
-  components.erase(entity);
+  if (!hasComponent(entity)) {
+    return;
+  }
+
+  // Move the last component into the freed slot to keep the array packed
+  size_t slot = sparse[entityIndex(entity)];
+  size_t last = components.size() - 1;
+  if (slot != last) {
+    components[slot] = std::move(components[last]);
+    denseEntities[slot] = denseEntities[last];
+    sparse[entityIndex(denseEntities[slot])] = slot;
+  }
+
+  components.pop_back();
+  denseEntities.pop_back();
+  sparse[entityIndex(entity)] = INVALID_SLOT;
+}
+
+template <typename T> void ComponentPool<T>::reserve(size_t additional) {
+  components.reserve(components.size() + additional);
+  denseEntities.reserve(denseEntities.size() + additional);
 }
 
 template <typename T> T *ComponentPool<T>::getComponent(EntityID entity) {
-  auto it = components.find(entity);
-  return (it != components.end()) ? &it->second : nullptr;
+  return hasComponent(entity) ? &components[sparse[entityIndex(entity)]]
+                               : nullptr;
 }
 
 template <typename T>
-T &ComponentManager::addComponent(EntityID entity, T component,
-                                  EntityManager &entityManager) {
-  auto &pool = getComponentPool<T>();
-  auto &addedComponent = pool.addComponent(entity, component);
-  entityManager.getComponentMask(entity).set(ComponentType<T>::ID());
-  return addedComponent;
+bool ComponentPool<T>::hasComponent(EntityID entity) const {
+  // The dense entity check rejects stale handles to a reused slot
+  EntityIndex index = entityIndex(entity);
+  return index < sparse.size() && sparse[index] != INVALID_SLOT &&
+         denseEntities[sparse[index]] == entity;
+}
+
+template <typename T> size_t ComponentPool<T>::size() const {
+  return components.size();
+}
+
+template <typename T> std::vector<T> &ComponentPool<T>::data() {
+  return components;
+}
+
+template <typename T>
+const std::vector<EntityID> &ComponentPool<T>::entities() const {
+  return denseEntities;
+}
+
+template <typename T>
+std::decay_t<T> *ComponentManager::addComponent(EntityID entity, T &&component,
+                                                EntityManager &entityManager) {
+  return emplaceComponent<std::decay_t<T>>(entity, entityManager,
+                                           std::forward<T>(component));
+}
+
+template <typename T, typename... Args>
+T *ComponentManager::emplaceComponent(EntityID entity,
+                                      EntityManager &entityManager,
+                                      Args &&...args) {
+  if (!entityManager.isAlive(entity)) {
+    return nullptr;
+  }
+
+  if constexpr (isTagComponent<T>) {
+    entityManager.setComponentBit(entity, ComponentType<T>::ID(), true);
+    return &tagComponent<T>();
+  } else if (archetypes) {
+    return archetypes->emplaceComponent<T>(entity, entityManager,
+                                           std::forward<Args>(args)...);
+  } else {
+    entityManager.setComponentBit(entity, ComponentType<T>::ID(), true);
+    return getComponentPool<T>().emplace(entity, std::forward<Args>(args)...);
+  }
 }
 
-template <typename T> void ComponentManager::removeComponent(EntityID entity) {
-  auto &pool = getComponentPool<T>();
-  pool.removeComponent(entity);
+template <typename T>
+void ComponentManager::removeComponent(EntityID entity,
+                                       EntityManager &entityManager) {
+  if (!entityManager.isAlive(entity)) {
+    return;
+  }
+
+  if constexpr (isTagComponent<T>) {
+    entityManager.setComponentBit(entity, ComponentType<T>::ID(), false);
+  } else if (archetypes) {
+    archetypes->removeComponent<T>(entity, entityManager);
+  } else {
+    entityManager.setComponentBit(entity, ComponentType<T>::ID(), false);
+    getComponentPool<T>().removeComponent(entity);
+  }
 }
 
 template <typename T> T *ComponentManager::getComponent(EntityID entity) {
-  auto &pool = getComponentPool<T>();
-  return pool.getComponent(entity);
+  static_assert(!isTagComponent<T>,
+                "Tag components have no storage, test the ComponentMask");
+  if (archetypes) {
+    return archetypes->getComponent<T>(entity);
+  }
+  return getComponentPool<T>().getComponent(entity);
+}
+
+inline ComponentManager::ComponentManager(StorageMode _mode) : mode(_mode) {
+  if (mode == StorageMode::Archetype) {
+    archetypes = std::make_unique<ArchetypeManager>();
+  } else {
+    createPools(RegisteredComponents());
+  }
+}
+
+inline StorageMode ComponentManager::storageMode() const { return mode; }
+
+inline void ComponentManager::destroyEntity(EntityID entity,
+                                            EntityManager &entityManager) {
+  if (!entityManager.isAlive(entity)) {
+    return;
+  }
+  if (archetypes) {
+    archetypes->destroyEntity(entity, entityManager);
+    return;
+  }
+
+  for (auto &pool : componentPools) {
+    if (pool) {
+      pool->removeComponent(entity);
+    }
+  }
+  entityManager.destroyEntity(entity);
+}
+
+inline void ComponentManager::reserve(size_t componentID, size_t additional) {
+  if (componentPools[componentID]) {
+    componentPools[componentID]->reserve(additional);
+  }
+}
+
+template <typename... Ts>
+ComponentView<Ts...> ComponentManager::view(EntityManager &entityManager) {
+  if (archetypes) {
+    return ComponentView<Ts...>(*archetypes, entityManager);
+  }
+  return ComponentView<Ts...>(findComponentPool<Ts>()..., entityManager);
+}
+
+template <typename... Ts>
+void ComponentManager::createPools(ComponentList<Ts...>) {
+  auto createPool = [this](auto *type) {
+    using T = std::remove_pointer_t<decltype(type)>;
+    if constexpr (!isTagComponent<T>) {
+      componentPools[ComponentType<T>::ID()] =
+          std::make_unique<ComponentPool<T>>();
+    }
+  };
+  (createPool(static_cast<Ts *>(nullptr)), ...);
 }
 
 template <typename T> ComponentPool<T> &ComponentManager::getComponentPool() {
-  auto typeIndex = std::type_index(typeid(T));
-  if (componentPools.find(typeIndex) == componentPools.end()) {
-    componentPools[typeIndex] = std::make_shared<ComponentPool<T>>();
+  // Pools are created up front, so this is a plain array index
+  return static_cast<ComponentPool<T> &>(
+      *componentPools[ComponentType<T>::ID()]);
+}
+
+template <typename T> ComponentPool<T> *ComponentManager::findComponentPool() {
+  if constexpr (isTagComponent<T>) {
+    return nullptr;
+  } else {
+    return &getComponentPool<T>();
   }
-  return *static_cast<ComponentPool<T> *>(componentPools[typeIndex].get());
+}
+
+template <typename... Ts>
+ComponentView<Ts...>::ComponentView(ComponentPool<Ts> *...pools,
+                                    EntityManager &entityManager)
+    : pools(pools...), entityManager(entityManager) {
+  static_assert((!isTagComponent<Ts> || ...),
+                "A view needs at least one non-tag component");
+  (requiredMask.set(ComponentType<Ts>::ID()), ...);
+}
+
+template <typename... Ts>
+ComponentView<Ts...>::ComponentView(ArchetypeManager &archetypes,
+                                    EntityManager &entityManager)
+    : archetypes(&archetypes), entityManager(entityManager) {
+  static_assert((!isTagComponent<Ts> || ...),
+                "A view needs at least one non-tag component");
+  (requiredMask.set(ComponentType<Ts>::ID()), ...);
+  (tagMask.set(ComponentType<Ts>::ID(), isTagComponent<Ts>), ...);
+}
+
+template <typename... Ts>
+template <typename... Us>
+ComponentView<Ts...> &ComponentView<Ts...>::exclude() {
+  (excludedMask.set(ComponentType<Us>::ID()), ...);
+  (tagMask.set(ComponentType<Us>::ID(), isTagComponent<Us>), ...);
+  return *this;
+}
+
+template <typename... Ts>
+template <typename Func>
+void ComponentView<Ts...>::each(Func &&func) {
+  if (archetypes) {
+    archetypes->eachChunk(requiredMask & ~tagMask, excludedMask & ~tagMask,
+                          [&](Archetype &archetype, size_t chunk) {
+                            eachInChunk({&archetype, chunk}, func);
+                          });
+    return;
+  }
+
+  const std::vector<EntityID> &entities = smallestPoolEntities();
+
+  // Walk backwards so swap-removal of the current entity doesn't skip anyone
+  for (size_t i = entities.size(); i-- > 0;) {
+    if (i >= entities.size()) {
+      continue;
+    }
+
+    EntityID entity = entities[i];
+    if (!matches(entity)) {
+      continue;
+    }
+
+    func(entity, component<Ts>(entity)...);
+  }
+}
+
+template <typename... Ts>
+template <typename Func>
+void ComponentView<Ts...>::parallelEach(JobSystem &jobSystem, size_t grainSize,
+                                        Func &&func) {
+  if (archetypes) {
+    std::vector<ChunkRef> chunks;
+    archetypes->eachChunk(requiredMask & ~tagMask, excludedMask & ~tagMask,
+                          [&chunks](Archetype &archetype, size_t chunk) {
+                            chunks.push_back({&archetype, chunk});
+                          });
+    jobSystem.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        eachInChunk(chunks[i], func);
+      }
+    });
+    return;
+  }
+
+  const std::vector<EntityID> &entities = smallestPoolEntities();
+
+  jobSystem.parallelFor(
+      entities.size(), grainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          EntityID entity = entities[i];
+          if (matches(entity)) {
+            func(entity, component<Ts>(entity)...);
+          }
+        }
+      });
+}
+
+template <typename... Ts>
+template <typename T>
+T &ComponentView<Ts...>::component(EntityID entity) {
+  if constexpr (isTagComponent<T>) {
+    return tagComponent<T>();
+  } else {
+    return *std::get<ComponentPool<T> *>(pools)->getComponent(entity);
+  }
+}
+
+template <typename... Ts>
+template <typename Func>
+void ComponentView<Ts...>::eachInChunk(const ChunkRef &ref, Func &func) {
+  auto visit = [&](size_t count, const EntityID *entities, Ts *...columns) {
+    // Data components already matched by archetype, only tags are left
+    bool checkTags = tagMask.any();
+    for (size_t i = 0; i < count; ++i) {
+      if (!checkTags || matches(entities[i])) {
+        func(entities[i], chunkRow<Ts>(columns, i)...);
+      }
+    }
+  };
+  visit(ref.archetype->chunkSize(ref.chunk),
+        ref.archetype->entities(ref.chunk),
+        chunkColumn<Ts>(*ref.archetype, ref.chunk)...);
+}
+
+template <typename... Ts>
+template <typename T>
+T *ComponentView<Ts...>::chunkColumn(Archetype &archetype, size_t chunk) {
+  if constexpr (isTagComponent<T>) {
+    return &tagComponent<T>();
+  } else {
+    return static_cast<T *>(archetype.column(ComponentType<T>::ID(), chunk));
+  }
+}
+
+template <typename... Ts>
+template <typename T>
+T &ComponentView<Ts...>::chunkRow(T *column, size_t row) {
+  return isTagComponent<T> ? *column : column[row];
+}
+
+template <typename... Ts>
+bool ComponentView<Ts...>::matches(EntityID entity) {
+  const ComponentMask &mask = entityManager.getComponentMask(entity);
+  return (mask & requiredMask) == requiredMask && (mask & excludedMask).none();
+}
+
+template <typename... Ts>
+const std::vector<EntityID> &
+ComponentView<Ts...>::smallestPoolEntities() const {
+  const std::vector<EntityID> *smallest = nullptr;
+  auto consider = [&smallest](auto *pool) {
+    // Tags have no pool and never drive iteration
+    if (pool && (!smallest || pool->size() < smallest->size())) {
+      smallest = &pool->entities();
+    }
+  };
+  std::apply([&consider](auto *...pool) { (consider(pool), ...); }, pools);
+  return *smallest;
 }
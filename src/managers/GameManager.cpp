@@ -1,16 +1,17 @@
 #include "./GameManager.h"
 
-GameManager::GameManager(EntityManager &em, ComponentManager &cm)
-    : entityManager(em), componentManager(cm) {
+GameManager::GameManager(EntityManager &em, ComponentManager &cm,
+                         MeshRegistry &meshes)
+    : entityManager(em), componentManager(cm), meshRegistry(meshes) {
   // Initialize the game state
-  initializeEntities(entityManager, componentManager);
+  initializeEntities(entityManager, componentManager, meshRegistry);
 }
 
 void GameManager::resetGame() {
   // Clear all entities and components
   entityManager = EntityManager();
-  componentManager = ComponentManager();
+  componentManager = ComponentManager(componentManager.storageMode());
 
-  // Re-initialize the game entities
-  initializeEntities(entityManager, componentManager);
+  // Re-initialize the game entities, reusing the meshes already loaded
+  initializeEntities(entityManager, componentManager, meshRegistry);
 }
@@ -3,14 +3,17 @@
 #include "../core/Entity.h"
 #include "../core/EntityInitializer.h"
 #include "./ComponentManager.h"
+#include "./MeshRegistry.h"
 
 class GameManager {
 public:
-  GameManager(EntityManager &entityManager, ComponentManager &componentManager);
+  GameManager(EntityManager &entityManager, ComponentManager &componentManager,
+              MeshRegistry &meshRegistry);
 
   void resetGame();
 
 private:
   EntityManager &entityManager;
   ComponentManager &componentManager;
+  MeshRegistry &meshRegistry;
 };
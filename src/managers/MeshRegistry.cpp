@@ -0,0 +1,23 @@
+#include "MeshRegistry.h"
+#include "../components/ModelLoader.h"
+#include <utility>
+
+MeshHandle MeshRegistry::load(const std::string &path) {
+  auto existing = handles.find(path);
+  if (existing != handles.end()) {
+    return existing->second;
+  }
+
+  Mesh mesh;
+  MeshHandle handle = INVALID_MESH;
+  if (ModelLoader::loadModel(path, mesh)) {
+    handle = static_cast<MeshHandle>(meshes.size());
+    meshes.push_back(std::move(mesh));
+  }
+  handles.emplace(path, handle);
+  return handle;
+}
+
+const Mesh &MeshRegistry::get(MeshHandle mesh) const { return meshes[mesh]; }
+
+size_t MeshRegistry::size() const { return meshes.size(); }
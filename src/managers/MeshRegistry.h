@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../components/Renderable.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Loads each model once and hands out a shared MeshHandle for it, so every
+// entity drawing the same asset references the same geometry.
+class MeshRegistry {
+public:
+  // Loads the model at path the first time it is asked for; later calls
+  // return the same handle. Returns INVALID_MESH if it can't be loaded.
+  MeshHandle load(const std::string &path);
+
+  const Mesh &get(MeshHandle mesh) const;
+  size_t size() const;
+
+private:
+  std::vector<Mesh> meshes;
+  // Failed loads are remembered as INVALID_MESH so they aren't retried
+  std::unordered_map<std::string, MeshHandle> handles;
+};
@@ -0,0 +1,77 @@
+#include "AABB.h"
+#include <algorithm>
+#include <cmath>
+
+AABB::AABB(const glm::vec3 &_min, const glm::vec3 &_max)
+    : min(_min), max(_max) {}
+
+bool AABB::overlaps(const AABB &other) const {
+  return max.x >= other.min.x && other.max.x >= min.x &&
+         max.y >= other.min.y && other.max.y >= min.y &&
+         max.z >= other.min.z && other.max.z >= min.z;
+}
+
+bool AABB::contains(const AABB &other) const {
+  return min.x <= other.min.x && min.y <= other.min.y &&
+         min.z <= other.min.z && max.x >= other.max.x &&
+         max.y >= other.max.y && max.z >= other.max.z;
+}
+
+glm::vec3 AABB::center() const { return (min + max) * 0.5f; }
+
+glm::vec3 AABB::extents() const { return (max - min) * 0.5f; }
+
+float AABB::surfaceArea() const {
+  glm::vec3 size = max - min;
+  return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+AABB AABB::fattened(float margin) const {
+  return AABB(min - glm::vec3(margin), max + glm::vec3(margin));
+}
+
+AABB AABB::transformed(const glm::mat4 &transform) const {
+  glm::vec3 newCenter = glm::vec3(transform * glm::vec4(center(), 1.0f));
+  // Each world axis sees the transformed box axes projected onto it
+  glm::vec3 halfSize = extents();
+  glm::vec3 extent(0.0f);
+  for (int axis = 0; axis < 3; ++axis) {
+    extent += glm::abs(glm::vec3(transform[axis])) * halfSize[axis];
+  }
+  return AABB(newCenter - extent, newCenter + extent);
+}
+
+bool AABB::raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+                   float maxDistance, float &distance) const {
+  float tMin = 0.0f;
+  float tMax = maxDistance;
+
+  for (int axis = 0; axis < 3; ++axis) {
+    if (std::abs(direction[axis]) < 1e-8f) {
+      // Parallel to the slab: miss unless the origin lies within it
+      if (origin[axis] < min[axis] || origin[axis] > max[axis]) {
+        return false;
+      }
+      continue;
+    }
+
+    float inverse = 1.0f / direction[axis];
+    float t1 = (min[axis] - origin[axis]) * inverse;
+    float t2 = (max[axis] - origin[axis]) * inverse;
+    if (t1 > t2) {
+      std::swap(t1, t2);
+    }
+    tMin = std::max(tMin, t1);
+    tMax = std::min(tMax, t2);
+    if (tMin > tMax) {
+      return false;
+    }
+  }
+
+  distance = tMin;
+  return true;
+}
+
+AABB AABB::merge(const AABB &a, const AABB &b) {
+  return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+}
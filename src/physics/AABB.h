@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Axis-aligned bounding box in world space
+struct AABB {
+  glm::vec3 min;
+  glm::vec3 max;
+
+  AABB(const glm::vec3 &_min = glm::vec3(0.0f),
+       const glm::vec3 &_max = glm::vec3(0.0f));
+
+  // Touching boxes count as overlapping
+  bool overlaps(const AABB &other) const;
+  bool contains(const AABB &other) const;
+  glm::vec3 center() const;
+  glm::vec3 extents() const;
+  float surfaceArea() const;
+  // Box grown by margin on every side
+  AABB fattened(float margin) const;
+  // Box enclosing this one after an affine transform
+  AABB transformed(const glm::mat4 &transform) const;
+
+  // Slab test. On a hit within [0, maxDistance] stores the entry distance
+  // along direction (0 when the origin is inside the box).
+  bool raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+               float maxDistance, float &distance) const;
+
+  // Smallest box enclosing both boxes
+  static AABB merge(const AABB &a, const AABB &b);
+};
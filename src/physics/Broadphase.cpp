@@ -0,0 +1,29 @@
+#include "Broadphase.h"
+#include "DynamicTreeBroadphase.h"
+#include "SpatialHashGrid.h"
+#include "SweepAndPrune.h"
+
+bool parseBroadphaseType(const std::string &name, BroadphaseType &type) {
+  if (name == "tree") {
+    type = BroadphaseType::DynamicTree;
+  } else if (name == "grid") {
+    type = BroadphaseType::SpatialHashGrid;
+  } else if (name == "sap") {
+    type = BroadphaseType::SweepAndPrune;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<Broadphase> createBroadphase(BroadphaseType type) {
+  switch (type) {
+  case BroadphaseType::SpatialHashGrid:
+    return std::make_unique<SpatialHashGrid>();
+  case BroadphaseType::SweepAndPrune:
+    return std::make_unique<SweepAndPrune>();
+  case BroadphaseType::DynamicTree:
+    break;
+  }
+  return std::make_unique<DynamicTreeBroadphase>();
+}
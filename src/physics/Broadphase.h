@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../core/Entity.h"
+#include "./AABB.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct RaycastHit {
+  EntityID entity;
+  // Distance along the ray to where it enters the proxy's bounds
+  float distance;
+};
+
+// Receives a proxy the ray enters and returns the distance to clip the ray
+// to: the current maxDistance to keep looking at every proxy, a confirmed
+// hit's distance to only look for nearer ones, or 0 to stop
+using RaycastCallback = std::function<float(const RaycastHit &hit)>;
+
+// Broadphase collision structure: tracks one proxy AABB per collidable entity
+// and returns the entities whose proxies may overlap a query box. Static
+// proxies are expected not to move.
+class Broadphase {
+public:
+  virtual ~Broadphase() = default;
+
+  virtual void insertProxy(EntityID entity, const AABB &aabb,
+                           bool isStatic) = 0;
+  virtual void moveProxy(EntityID entity, const AABB &aabb) = 0;
+  virtual void removeProxy(EntityID entity) = 0;
+  virtual bool hasProxy(EntityID entity) const = 0;
+  virtual void clear() = 0;
+
+  // Appends every entity whose proxy overlaps aabb to results
+  virtual void query(const AABB &aabb,
+                     std::vector<EntityID> &results) const = 0;
+  // Calls callback once for each proxy the ray enters within the current
+  // maxDistance, in no particular order. direction should be normalized so
+  // distances are in world units.
+  void raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+               float maxDistance, const RaycastCallback &callback) const {
+    sweepBox(origin, glm::vec3(0.0f), direction, maxDistance, callback);
+  }
+  // Like raycast for a box of half size extent centred on the ray, as if
+  // every proxy were grown by extent on each side. Shape casts use it to
+  // visit proxies along the way instead of querying the whole sweep.
+  virtual void sweepBox(const glm::vec3 &origin, const glm::vec3 &extent,
+                        const glm::vec3 &direction, float maxDistance,
+                        const RaycastCallback &callback) const = 0;
+
+  // Whether the broadphase keeps the pairs of overlapping proxies up to date
+  // as they move, so a proxy's pairs can be read back instead of queried.
+  // Pairs of two static proxies aren't tracked.
+  virtual bool tracksPairs() const { return false; }
+  // Appends the entities whose proxies overlap the entity's proxy. Only
+  // available when tracksPairs().
+  virtual void pairsOf(EntityID, std::vector<EntityID> &) const {}
+  // Appends the pairs that stopped overlapping since the last call to
+  // removed, including those of removed proxies. Only available when
+  // tracksPairs().
+  virtual void
+  takeRemovedPairs(std::vector<std::pair<EntityID, EntityID>> &) {}
+};
+
+enum class BroadphaseType { DynamicTree, SpatialHashGrid, SweepAndPrune };
+
+// Parses "tree", "grid" or "sap". Returns false for any other name.
+bool parseBroadphaseType(const std::string &name, BroadphaseType &type);
+std::unique_ptr<Broadphase> createBroadphase(BroadphaseType type);
@@ -0,0 +1,174 @@
+#include "ContactSolver.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+// Penetration left alone so resting contacts stay touching between steps
+const float PENETRATION_SLOP = 0.005f;
+// Fraction of the remaining penetration removed per position iteration
+const float POSITION_CORRECTION = 0.8f;
+// Cached impulses are only reused while the normal hasn't turned much
+const float WARM_START_NORMAL_DOT = 0.9f;
+} // unnamed namespace
+
+bool computeContact(const AABB &a, const AABB &b, glm::vec3 &normal,
+                    float &depth) {
+  if (!a.overlaps(b)) {
+    return false;
+  }
+
+  glm::vec3 overlap = glm::min(a.max, b.max) - glm::max(a.min, b.min);
+  int axis = 0;
+  if (overlap.y < overlap[axis]) {
+    axis = 1;
+  }
+  if (overlap.z < overlap[axis]) {
+    axis = 2;
+  }
+
+  normal = glm::vec3(0.0f);
+  normal[axis] = a.center()[axis] < b.center()[axis] ? -1.0f : 1.0f;
+  depth = overlap[axis];
+  return true;
+}
+
+ContactSolver::ContactSolver(int _velocityIterations, int _positionIterations)
+    : velocityIterations(_velocityIterations),
+      positionIterations(_positionIterations) {}
+
+void ContactSolver::solve(std::vector<SolverBody> &bodies,
+                          std::vector<Contact> &contacts, float deltaTime) {
+  ++step;
+  initialVelocities.clear();
+  for (const SolverBody &body : bodies) {
+    initialVelocities.push_back(body.velocity);
+  }
+
+  // Warm start from last step's impulses
+  for (Contact &contact : contacts) {
+    auto cached = cache.find(pairKey(contact));
+    contact.normalImpulse = 0.0f;
+    if (cached != cache.end() && cached->second.step + 1 == step &&
+        glm::dot(cached->second.normal, keyNormal(contact)) >
+            WARM_START_NORMAL_DOT) {
+      contact.normalImpulse = cached->second.normalImpulse;
+      applyImpulse(bodies, contact, contact.normalImpulse);
+    }
+  }
+
+  auto inverseMass = [&bodies](uint32_t body) {
+    return body == Contact::NO_BODY ? 0.0f : bodies[body].inverseMass;
+  };
+  auto velocity = [&bodies](uint32_t body) {
+    return body == Contact::NO_BODY ? glm::vec3(0.0f) : bodies[body].velocity;
+  };
+  auto correction = [&bodies](uint32_t body) {
+    return body == Contact::NO_BODY ? glm::vec3(0.0f)
+                                    : bodies[body].correction;
+  };
+
+  // Stop the bodies from approaching along each contact normal
+  for (int iteration = 0; iteration < velocityIterations; ++iteration) {
+    for (Contact &contact : contacts) {
+      float massSum = inverseMass(contact.bodyA) + inverseMass(contact.bodyB);
+      if (massSum <= 0.0f) {
+        continue;
+      }
+
+      float normalSpeed = glm::dot(
+          velocity(contact.bodyA) - velocity(contact.bodyB), contact.normal);
+      // Clamp the accumulated impulse, not the increment, so earlier
+      // iterations can be undone
+      float previous = contact.normalImpulse;
+      contact.normalImpulse =
+          std::max(previous - normalSpeed / massSum, 0.0f);
+      applyImpulse(bodies, contact, contact.normalImpulse - previous);
+    }
+  }
+
+  // Redo this step's motion with the solved velocities
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    bodies[i].correction +=
+        (bodies[i].velocity - initialVelocities[i]) * deltaTime;
+  }
+
+  // Push overlapping bodies apart, split by inverse mass
+  for (int iteration = 0; iteration < positionIterations; ++iteration) {
+    for (const Contact &contact : contacts) {
+      float massSum = inverseMass(contact.bodyA) + inverseMass(contact.bodyB);
+      if (massSum <= 0.0f) {
+        continue;
+      }
+
+      float separated = glm::dot(
+          correction(contact.bodyA) - correction(contact.bodyB),
+          contact.normal);
+      float depth = contact.depth - separated - PENETRATION_SLOP;
+      if (depth <= 0.0f) {
+        continue;
+      }
+
+      glm::vec3 push = contact.normal * (POSITION_CORRECTION * depth / massSum);
+      if (contact.bodyA != Contact::NO_BODY) {
+        SolverBody &body = bodies[contact.bodyA];
+        body.correction += push * body.inverseMass;
+      }
+      if (contact.bodyB != Contact::NO_BODY) {
+        SolverBody &body = bodies[contact.bodyB];
+        body.correction -= push * body.inverseMass;
+      }
+    }
+  }
+
+  // Contacts that weren't found this step are dropped from the cache, or
+  // left to go stale until their pair is forgotten
+  if (!keepsPairs) {
+    cache.clear();
+  }
+  for (const Contact &contact : contacts) {
+    cache[pairKey(contact)] = {keyNormal(contact), contact.normalImpulse,
+                               step};
+  }
+}
+
+size_t ContactSolver::cachedContactCount() const { return cache.size(); }
+
+void ContactSolver::clear() { cache.clear(); }
+
+void ContactSolver::setKeepsPairs(bool _keepsPairs) {
+  keepsPairs = _keepsPairs;
+}
+
+void ContactSolver::forgetPair(EntityID a, EntityID b) {
+  cache.erase({std::min(a, b), std::max(a, b)});
+}
+
+bool ContactSolver::PairKey::operator==(const PairKey &other) const {
+  return first == other.first && second == other.second;
+}
+
+size_t ContactSolver::PairKeyHash::operator()(const PairKey &key) const {
+  std::hash<EntityID> hash;
+  return hash(key.first) ^ (hash(key.second) * 0x9E3779B97F4A7C15ull);
+}
+
+ContactSolver::PairKey ContactSolver::pairKey(const Contact &contact) {
+  return {std::min(contact.entityA, contact.entityB),
+          std::max(contact.entityA, contact.entityB)};
+}
+
+glm::vec3 ContactSolver::keyNormal(const Contact &contact) {
+  return contact.entityA < contact.entityB ? contact.normal : -contact.normal;
+}
+
+void ContactSolver::applyImpulse(std::vector<SolverBody> &bodies,
+                                 const Contact &contact, float impulse) {
+  if (contact.bodyA != Contact::NO_BODY) {
+    bodies[contact.bodyA].velocity +=
+        contact.normal * (impulse * bodies[contact.bodyA].inverseMass);
+  }
+  if (contact.bodyB != Contact::NO_BODY) {
+    bodies[contact.bodyB].velocity -=
+        contact.normal * (impulse * bodies[contact.bodyB].inverseMass);
+  }
+}
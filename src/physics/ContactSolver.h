@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../core/Entity.h"
+#include "AABB.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+// Velocity and mass of a body taking part in contact resolution
+struct SolverBody {
+  glm::vec3 velocity;
+  float inverseMass;
+  // Position change accumulated by the solver, applied by the caller
+  glm::vec3 correction = glm::vec3(0.0f);
+};
+
+struct Contact {
+  // Pair identity, used to carry impulses over between steps
+  EntityID entityA;
+  EntityID entityB;
+  // Indices into the solver bodies; bodyB is NO_BODY for static or sleeping
+  // colliders, which don't move
+  uint32_t bodyA;
+  uint32_t bodyB;
+  // Minimum translation direction, pointing from B towards A
+  glm::vec3 normal;
+  float depth;
+  // Accumulated normal impulse
+  float normalImpulse = 0.0f;
+
+  static constexpr uint32_t NO_BODY = ~uint32_t(0);
+};
+
+// Minimum translation vector of two overlapping boxes: the axis of least
+// overlap, with normal pointing from b towards a. Returns false if the boxes
+// don't overlap; touching boxes give a contact of depth 0.
+bool computeContact(const AABB &a, const AABB &b, glm::vec3 &normal,
+                    float &depth);
+
+// Sequential-impulse contact solver. Contacts persist across steps by entity
+// pair and are warm-started with the impulse they ended the previous step
+// with, so resting stacks converge within a small fixed iteration budget.
+// Bodies are integrated before their contacts are known, so the velocity the
+// solver removes is also taken back out of this step's motion. Remaining
+// penetration is removed by a separate position pass rather than a velocity
+// bias, so it doesn't add energy.
+class ContactSolver {
+public:
+  ContactSolver(int velocityIterations = 8, int positionIterations = 3);
+
+  // Solves the contacts of a step of deltaTime and caches their impulses for
+  // the next step
+  void solve(std::vector<SolverBody> &bodies, std::vector<Contact> &contacts,
+             float deltaTime);
+  size_t cachedContactCount() const;
+  void clear();
+
+  // Keeps cached contacts until forgetPair is called for their pair instead
+  // of rebuilding the cache every step, for callers that learn from the
+  // broadphase when pairs separate. Only the previous step's contacts are
+  // warm-started either way.
+  void setKeepsPairs(bool keepsPairs);
+  void forgetPair(EntityID a, EntityID b);
+
+private:
+  struct PairKey {
+    EntityID first;
+    EntityID second;
+
+    bool operator==(const PairKey &other) const;
+  };
+
+  struct PairKeyHash {
+    size_t operator()(const PairKey &key) const;
+  };
+
+  struct CachedContact {
+    // Normal pointing towards the first entity of the key
+    glm::vec3 normal;
+    float normalImpulse;
+    // Step the contact was last solved in
+    uint64_t step;
+  };
+
+  int velocityIterations;
+  int positionIterations;
+  bool keepsPairs = false;
+  // Steps solved so far
+  uint64_t step = 0;
+  std::unordered_map<PairKey, CachedContact, PairKeyHash> cache;
+  // Body velocities before solving
+  std::vector<glm::vec3> initialVelocities;
+
+  // Key of the contact's pair, independent of which body is A
+  static PairKey pairKey(const Contact &contact);
+  static glm::vec3 keyNormal(const Contact &contact);
+  static void applyImpulse(std::vector<SolverBody> &bodies,
+                           const Contact &contact, float impulse);
+};
@@ -0,0 +1,220 @@
+#include "DynamicAABBTree.h"
+#include <algorithm>
+#include <utility>
+
+DynamicAABBTree::DynamicAABBTree(float _margin) : margin(_margin) {}
+
+int DynamicAABBTree::createProxy(const AABB &aabb, EntityID entity) {
+  int proxy = allocateNode();
+  nodes[proxy].aabb = aabb.fattened(margin);
+  nodes[proxy].entity = entity;
+  nodes[proxy].height = 0;
+  insertLeaf(proxy);
+  return proxy;
+}
+
+void DynamicAABBTree::destroyProxy(int proxy) {
+  removeLeaf(proxy);
+  freeNode(proxy);
+}
+
+bool DynamicAABBTree::moveProxy(int proxy, const AABB &aabb) {
+  // Still inside the fat box, nothing to do
+  if (nodes[proxy].aabb.contains(aabb)) {
+    return false;
+  }
+
+  removeLeaf(proxy);
+  nodes[proxy].aabb = aabb.fattened(margin);
+  insertLeaf(proxy);
+  return true;
+}
+
+void DynamicAABBTree::clear() {
+  nodes.clear();
+  root = NULL_NODE;
+  freeList = NULL_NODE;
+}
+
+const AABB &DynamicAABBTree::fatAABB(int proxy) const {
+  return nodes[proxy].aabb;
+}
+
+EntityID DynamicAABBTree::entity(int proxy) const {
+  return nodes[proxy].entity;
+}
+
+int DynamicAABBTree::height() const {
+  return root == NULL_NODE ? 0 : nodes[root].height;
+}
+
+int DynamicAABBTree::allocateNode() {
+  if (freeList == NULL_NODE) {
+    nodes.emplace_back();
+    return static_cast<int>(nodes.size() - 1);
+  }
+
+  int node = freeList;
+  freeList = nodes[node].parent;
+  nodes[node] = Node();
+  return node;
+}
+
+void DynamicAABBTree::freeNode(int node) {
+  nodes[node].parent = freeList;
+  nodes[node].height = -1;
+  freeList = node;
+}
+
+void DynamicAABBTree::insertLeaf(int leaf) {
+  if (root == NULL_NODE) {
+    root = leaf;
+    nodes[root].parent = NULL_NODE;
+    return;
+  }
+
+  // Descend towards the sibling with the lowest surface area cost
+  AABB leafAABB = nodes[leaf].aabb;
+  int index = root;
+  while (!nodes[index].isLeaf()) {
+    const Node &node = nodes[index];
+    float area = node.aabb.surfaceArea();
+    float combinedArea = AABB::merge(node.aabb, leafAABB).surfaceArea();
+
+    // Cost of making a new parent for this node and the leaf
+    float cost = 2.0f * combinedArea;
+    // Minimum cost of pushing the leaf further down
+    float inheritanceCost = 2.0f * (combinedArea - area);
+
+    auto descendCost = [&](int child) {
+      const Node &childNode = nodes[child];
+      float mergedArea =
+          AABB::merge(childNode.aabb, leafAABB).surfaceArea();
+      if (childNode.isLeaf()) {
+        return mergedArea + inheritanceCost;
+      }
+      return mergedArea - childNode.aabb.surfaceArea() + inheritanceCost;
+    };
+    float cost1 = descendCost(node.child1);
+    float cost2 = descendCost(node.child2);
+
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  // Pair the leaf with the chosen sibling under a new parent
+  int sibling = index;
+  int oldParent = nodes[sibling].parent;
+  int newParent = allocateNode();
+  nodes[newParent].parent = oldParent;
+  nodes[newParent].aabb = AABB::merge(leafAABB, nodes[sibling].aabb);
+  nodes[newParent].height = nodes[sibling].height + 1;
+  nodes[newParent].child1 = sibling;
+  nodes[newParent].child2 = leaf;
+  nodes[sibling].parent = newParent;
+  nodes[leaf].parent = newParent;
+
+  if (oldParent == NULL_NODE) {
+    root = newParent;
+  } else if (nodes[oldParent].child1 == sibling) {
+    nodes[oldParent].child1 = newParent;
+  } else {
+    nodes[oldParent].child2 = newParent;
+  }
+
+  refit(newParent);
+}
+
+void DynamicAABBTree::removeLeaf(int leaf) {
+  if (leaf == root) {
+    root = NULL_NODE;
+    return;
+  }
+
+  int parent = nodes[leaf].parent;
+  int grandParent = nodes[parent].parent;
+  int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2
+                                             : nodes[parent].child1;
+
+  // The sibling takes the parent's place
+  nodes[sibling].parent = grandParent;
+  freeNode(parent);
+  if (grandParent == NULL_NODE) {
+    root = sibling;
+    return;
+  }
+
+  if (nodes[grandParent].child1 == parent) {
+    nodes[grandParent].child1 = sibling;
+  } else {
+    nodes[grandParent].child2 = sibling;
+  }
+  refit(grandParent);
+}
+
+void DynamicAABBTree::refit(int node) {
+  while (node != NULL_NODE) {
+    node = balance(node);
+
+    Node &current = nodes[node];
+    const Node &child1 = nodes[current.child1];
+    const Node &child2 = nodes[current.child2];
+    current.height = 1 + std::max(child1.height, child2.height);
+    current.aabb = AABB::merge(child1.aabb, child2.aabb);
+
+    node = current.parent;
+  }
+}
+
+int DynamicAABBTree::balance(int indexA) {
+  Node &a = nodes[indexA];
+  if (a.isLeaf() || a.height < 2) {
+    return indexA;
+  }
+
+  int indexB = a.child1;
+  int indexC = a.child2;
+  int difference = nodes[indexC].height - nodes[indexB].height;
+  if (difference >= -1 && difference <= 1) {
+    return indexA;
+  }
+
+  // Promote the taller child, which adopts A and gives A its shorter child
+  bool promoteC = difference > 1;
+  int indexUp = promoteC ? indexC : indexB;
+  int indexKept = promoteC ? indexB : indexC;
+  Node &up = nodes[indexUp];
+  int indexF = up.child1;
+  int indexG = up.child2;
+
+  up.child1 = indexA;
+  up.parent = a.parent;
+  a.parent = indexUp;
+  if (up.parent == NULL_NODE) {
+    root = indexUp;
+  } else if (nodes[up.parent].child1 == indexA) {
+    nodes[up.parent].child1 = indexUp;
+  } else {
+    nodes[up.parent].child2 = indexUp;
+  }
+
+  // The taller grandchild stays with the promoted node
+  if (nodes[indexF].height < nodes[indexG].height) {
+    std::swap(indexF, indexG);
+  }
+  up.child2 = indexF;
+  if (promoteC) {
+    a.child2 = indexG;
+  } else {
+    a.child1 = indexG;
+  }
+  nodes[indexG].parent = indexA;
+
+  a.aabb = AABB::merge(nodes[indexKept].aabb, nodes[indexG].aabb);
+  a.height = 1 + std::max(nodes[indexKept].height, nodes[indexG].height);
+  up.aabb = AABB::merge(a.aabb, nodes[indexF].aabb);
+  up.height = 1 + std::max(a.height, nodes[indexF].height);
+  return indexUp;
+}
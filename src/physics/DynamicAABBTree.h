@@ -0,0 +1,144 @@
+#pragma once
+
+#include "../core/Entity.h"
+#include "./AABB.h"
+#include <utility>
+#include <vector>
+
+// Incremental bounding volume hierarchy. Leaves store fattened AABBs so a
+// proxy that moves a little stays inside its box and the tree is left alone;
+// only when it escapes is the leaf removed and reinserted. Insertion walks
+// down the tree picking the child with the lowest surface area cost, and
+// ancestors are refit and rebalanced with AVL-style rotations on the way up.
+class DynamicAABBTree {
+public:
+  static constexpr int NULL_NODE = -1;
+
+  explicit DynamicAABBTree(float margin = 0.0f);
+
+  // Returns the proxy ID of the new leaf
+  int createProxy(const AABB &aabb, EntityID entity);
+  void destroyProxy(int proxy);
+  // Returns true if the leaf had to be reinserted
+  bool moveProxy(int proxy, const AABB &aabb);
+  void clear();
+
+  const AABB &fatAABB(int proxy) const;
+  EntityID entity(int proxy) const;
+  // Height of the root, 0 for a single leaf
+  int height() const;
+
+  // Calls callback(proxy) for each leaf whose fat AABB overlaps aabb.
+  // Stops early when the callback returns false.
+  template <typename Callback>
+  void query(const AABB &aabb, Callback &&callback) const;
+  // Calls callback(proxy, distance) for each leaf whose fat AABB the ray
+  // enters within maxDistance. The callback returns the new maxDistance, so
+  // returning the hit distance clips the ray and returning 0 stops the cast.
+  template <typename Callback>
+  void raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+               float maxDistance, Callback &&callback) const;
+  // Same, with every fat AABB grown by extent on each side
+  template <typename Callback>
+  void raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+               float maxDistance, const glm::vec3 &extent,
+               Callback &&callback) const;
+
+private:
+  struct Node {
+    AABB aabb;
+    EntityID entity = INVALID_ENTITY;
+    // Next free node while the node is on the free list
+    int parent = NULL_NODE;
+    int child1 = NULL_NODE;
+    int child2 = NULL_NODE;
+    // Leaves are 0, free nodes -1
+    int height = -1;
+
+    bool isLeaf() const { return child1 == NULL_NODE; }
+  };
+
+  float margin;
+  int root = NULL_NODE;
+  int freeList = NULL_NODE;
+  std::vector<Node> nodes;
+
+  int allocateNode();
+  void freeNode(int node);
+  void insertLeaf(int leaf);
+  void removeLeaf(int leaf);
+  // Recomputes bounds and heights from node up to the root
+  void refit(int node);
+  // Rotates the subtree at node if it is imbalanced, returns its new root
+  int balance(int node);
+};
+
+template <typename Callback>
+void DynamicAABBTree::query(const AABB &aabb, Callback &&callback) const {
+  if (root == NULL_NODE) {
+    return;
+  }
+
+  std::vector<int> stack;
+  stack.reserve(64);
+  stack.push_back(root);
+  while (!stack.empty()) {
+    const Node &node = nodes[stack.back()];
+    int index = stack.back();
+    stack.pop_back();
+
+    if (!node.aabb.overlaps(aabb)) {
+      continue;
+    }
+    if (node.isLeaf()) {
+      if (!callback(index)) {
+        return;
+      }
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+}
+
+template <typename Callback>
+void DynamicAABBTree::raycast(const glm::vec3 &origin,
+                              const glm::vec3 &direction, float maxDistance,
+                              Callback &&callback) const {
+  raycast(origin, direction, maxDistance, glm::vec3(0.0f),
+          std::forward<Callback>(callback));
+}
+
+template <typename Callback>
+void DynamicAABBTree::raycast(const glm::vec3 &origin,
+                              const glm::vec3 &direction, float maxDistance,
+                              const glm::vec3 &extent,
+                              Callback &&callback) const {
+  if (root == NULL_NODE) {
+    return;
+  }
+
+  std::vector<int> stack;
+  stack.reserve(64);
+  stack.push_back(root);
+  while (!stack.empty()) {
+    const Node &node = nodes[stack.back()];
+    int index = stack.back();
+    stack.pop_back();
+
+    float distance;
+    AABB bounds(node.aabb.min - extent, node.aabb.max + extent);
+    if (!bounds.raycast(origin, direction, maxDistance, distance)) {
+      continue;
+    }
+    if (node.isLeaf()) {
+      maxDistance = callback(index, distance);
+      if (maxDistance <= 0.0f) {
+        return;
+      }
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+}
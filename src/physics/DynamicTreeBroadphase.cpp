@@ -0,0 +1,106 @@
+#include "DynamicTreeBroadphase.h"
+#include <algorithm>
+
+DynamicTreeBroadphase::DynamicTreeBroadphase(float dynamicMargin)
+    : staticTree(0.0f), dynamicTree(dynamicMargin) {}
+
+void DynamicTreeBroadphase::insertProxy(EntityID entity, const AABB &aabb,
+                                        bool isStatic) {
+  if (hasProxy(entity)) {
+    moveProxy(entity, aabb);
+    return;
+  }
+
+  if (isStatic) {
+    proxies[entity] = {staticTree.createProxy(aabb, entity), true};
+    return;
+  }
+
+  int proxy = dynamicTree.createProxy(aabb, entity);
+  if (static_cast<size_t>(proxy) >= dynamicBounds.size()) {
+    dynamicBounds.resize(proxy + 1);
+  }
+  dynamicBounds[proxy] = aabb;
+  proxies[entity] = {proxy, false};
+}
+
+void DynamicTreeBroadphase::moveProxy(EntityID entity, const AABB &aabb) {
+  auto it = proxies.find(entity);
+  if (it == proxies.end()) {
+    return;
+  }
+
+  if (it->second.isStatic) {
+    // Rare: static geometry that was moved by hand
+    staticTree.moveProxy(it->second.proxy, aabb);
+    return;
+  }
+  dynamicTree.moveProxy(it->second.proxy, aabb);
+  dynamicBounds[it->second.proxy] = aabb;
+}
+
+void DynamicTreeBroadphase::removeProxy(EntityID entity) {
+  auto it = proxies.find(entity);
+  if (it == proxies.end()) {
+    return;
+  }
+
+  if (it->second.isStatic) {
+    staticTree.destroyProxy(it->second.proxy);
+  } else {
+    dynamicTree.destroyProxy(it->second.proxy);
+  }
+  proxies.erase(it);
+}
+
+bool DynamicTreeBroadphase::hasProxy(EntityID entity) const {
+  return proxies.count(entity) > 0;
+}
+
+void DynamicTreeBroadphase::clear() {
+  staticTree.clear();
+  dynamicTree.clear();
+  proxies.clear();
+  dynamicBounds.clear();
+}
+
+void DynamicTreeBroadphase::query(const AABB &aabb,
+                                  std::vector<EntityID> &results) const {
+  staticTree.query(aabb, [&](int proxy) {
+    results.push_back(staticTree.entity(proxy));
+    return true;
+  });
+  dynamicTree.query(aabb, [&](int proxy) {
+    if (dynamicBounds[proxy].overlaps(aabb)) {
+      results.push_back(dynamicTree.entity(proxy));
+    }
+    return true;
+  });
+}
+
+void DynamicTreeBroadphase::sweepBox(const glm::vec3 &origin,
+                                     const glm::vec3 &extent,
+                                     const glm::vec3 &direction,
+                                     float maxDistance,
+                                     const RaycastCallback &callback) const {
+  // Each callback may clip the ray, which prunes the rest of both trees
+  staticTree.raycast(origin, direction, maxDistance, extent,
+                     [&](int proxy, float distance) {
+                       maxDistance =
+                           callback({staticTree.entity(proxy), distance});
+                       return maxDistance;
+                     });
+  if (maxDistance <= 0.0f) {
+    return;
+  }
+  dynamicTree.raycast(
+      origin, direction, maxDistance, extent, [&](int proxy, float) {
+        const AABB &exact = dynamicBounds[proxy];
+        float distance;
+        if (AABB(exact.min - extent, exact.max + extent)
+                .raycast(origin, direction, maxDistance, distance)) {
+          maxDistance = callback({dynamicTree.entity(proxy), distance});
+        }
+        return maxDistance;
+      });
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "./Broadphase.h"
+#include "./DynamicAABBTree.h"
+#include <unordered_map>
+#include <vector>
+
+// Broadphase backed by two dynamic AABB trees: one for static colliders,
+// which are inserted once with tight bounds and never restructured, and one
+// with fattened bounds for moving bodies.
+class DynamicTreeBroadphase : public Broadphase {
+public:
+  explicit DynamicTreeBroadphase(float dynamicMargin = 0.1f);
+
+  void insertProxy(EntityID entity, const AABB &aabb, bool isStatic) override;
+  void moveProxy(EntityID entity, const AABB &aabb) override;
+  void removeProxy(EntityID entity) override;
+  bool hasProxy(EntityID entity) const override;
+  void clear() override;
+
+  void query(const AABB &aabb, std::vector<EntityID> &results) const override;
+  void sweepBox(const glm::vec3 &origin, const glm::vec3 &extent,
+                const glm::vec3 &direction, float maxDistance,
+                const RaycastCallback &callback) const override;
+
+private:
+  struct ProxyRef {
+    int proxy;
+    bool isStatic;
+  };
+
+  DynamicAABBTree staticTree;
+  DynamicAABBTree dynamicTree;
+  std::unordered_map<EntityID, ProxyRef> proxies;
+  // Exact bounds of each dynamic leaf, indexed by proxy ID, so queries don't
+  // report pairs that only overlap through the fat margin
+  std::vector<AABB> dynamicBounds;
+};
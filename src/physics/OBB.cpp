@@ -0,0 +1,180 @@
+#include "OBB.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+// Cross products of nearly parallel edges are too short to normalize
+const float MIN_AXIS_LENGTH = 1e-6f;
+// An edge axis must beat the best face axis by this factor to be chosen
+const float EDGE_AXIS_PREFERENCE = 0.95f;
+
+// Half-length of the box's projection onto axis
+float projectedRadius(const OBB &box, const glm::vec3 &axis) {
+  return box.halfExtents.x * std::abs(glm::dot(box.axes[0], axis)) +
+         box.halfExtents.y * std::abs(glm::dot(box.axes[1], axis)) +
+         box.halfExtents.z * std::abs(glm::dot(box.axes[2], axis));
+}
+
+// Calls func(axis, isEdgeAxis) for the face normals of both boxes, then for
+// the cross products of their edges, until func returns false. Returns
+// whether every axis was visited.
+template <typename Func>
+bool forEachSeparatingAxis(const OBB &a, const OBB &b, Func &&func) {
+  for (int i = 0; i < 3; ++i) {
+    if (!func(a.axes[i], false) || !func(b.axes[i], false)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      glm::vec3 axis = glm::cross(a.axes[i], b.axes[j]);
+      float length = glm::length(axis);
+      if (length >= MIN_AXIS_LENGTH && !func(axis / length, true)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+} // unnamed namespace
+
+OBB::OBB(const glm::vec3 &_center, const glm::vec3 &_halfExtents,
+         const glm::quat &orientation)
+    : center(_center), halfExtents(_halfExtents),
+      axes(glm::mat3_cast(orientation)) {}
+
+AABB OBB::bounds() const {
+  // Each world axis sees the box's projection onto it
+  glm::vec3 extent(0.0f);
+  for (int axis = 0; axis < 3; ++axis) {
+    extent += glm::abs(axes[axis]) * halfExtents[axis];
+  }
+  return AABB(center - extent, center + extent);
+}
+
+OBB OBB::fattened(float margin) const {
+  OBB grown = *this;
+  grown.halfExtents += glm::vec3(margin);
+  return grown;
+}
+
+bool OBB::raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+                  float maxDistance, float &distance,
+                  glm::vec3 &normal) const {
+  // Into the box's frame, where it is an AABB around the origin
+  glm::mat3 toLocal = glm::transpose(axes);
+  glm::vec3 localOrigin = toLocal * (origin - center);
+  glm::vec3 localDirection = toLocal * direction;
+
+  float tMin = 0.0f;
+  float tMax = maxDistance;
+  int entryAxis = -1;
+  for (int axis = 0; axis < 3; ++axis) {
+    if (std::abs(localDirection[axis]) < 1e-8f) {
+      // Parallel to the slab: miss unless the origin lies within it
+      if (std::abs(localOrigin[axis]) > halfExtents[axis]) {
+        return false;
+      }
+      continue;
+    }
+
+    float inverse = 1.0f / localDirection[axis];
+    float t1 = (-halfExtents[axis] - localOrigin[axis]) * inverse;
+    float t2 = (halfExtents[axis] - localOrigin[axis]) * inverse;
+    if (t1 > t2) {
+      std::swap(t1, t2);
+    }
+    if (t1 > tMin) {
+      tMin = t1;
+      entryAxis = axis;
+    }
+    tMax = std::min(tMax, t2);
+    if (tMin > tMax) {
+      return false;
+    }
+  }
+
+  distance = tMin;
+  if (entryAxis < 0) {
+    normal = -direction;
+  } else {
+    // The face entered looks back along the ray
+    float side = localDirection[entryAxis] < 0.0f ? 1.0f : -1.0f;
+    normal = axes[entryAxis] * side;
+  }
+  return true;
+}
+
+bool intersectOBB(const OBB &a, const OBB &b, glm::vec3 &normal,
+                  float &depth) {
+  glm::vec3 offset = a.center - b.center;
+  bool hasAxis = false;
+
+  // Stops at an axis that separates the boxes, otherwise keeps the axis with
+  // the least penetration
+  return forEachSeparatingAxis(
+      a, b, [&](const glm::vec3 &axis, bool isEdgeAxis) {
+        float distance = glm::dot(offset, axis);
+        float overlap = projectedRadius(a, axis) + projectedRadius(b, axis) -
+                        std::abs(distance);
+        if (overlap < 0.0f) {
+          return false;
+        }
+        float preference = isEdgeAxis ? EDGE_AXIS_PREFERENCE : 1.0f;
+        if (!hasAxis || overlap < depth * preference) {
+          normal = distance < 0.0f ? -axis : axis;
+          depth = overlap;
+          hasAxis = true;
+        }
+        return true;
+      });
+}
+
+bool sweepOBB(const OBB &moving, const glm::vec3 &displacement,
+              const OBB &target, SweepHit &hit) {
+  glm::vec3 offset = moving.center - target.center;
+  float entryTime = -std::numeric_limits<float>::infinity();
+  float exitTime = std::numeric_limits<float>::infinity();
+  glm::vec3 entryNormal(0.0f);
+
+  // On each axis the projections overlap during an interval of time; the
+  // boxes meet when all the intervals do
+  bool isSeparable = !forEachSeparatingAxis(
+      moving, target, [&](const glm::vec3 &axis, bool) {
+        float radius =
+            projectedRadius(moving, axis) + projectedRadius(target, axis);
+        float distance = glm::dot(offset, axis);
+        float speed = glm::dot(displacement, axis);
+        if (std::abs(speed) < 1e-8f) {
+          // Not moving along this axis: the boxes must already overlap on it
+          return std::abs(distance) <= radius;
+        }
+
+        float entry = (-radius - distance) / speed;
+        float exit = (radius - distance) / speed;
+        if (entry > exit) {
+          std::swap(entry, exit);
+        }
+        if (entry > entryTime) {
+          entryTime = entry;
+          entryNormal = speed < 0.0f ? axis : -axis;
+        }
+        exitTime = std::min(exitTime, exit);
+        return entryTime <= exitTime && exitTime >= 0.0f && entryTime <= 1.0f;
+      });
+  if (isSeparable) {
+    return false;
+  }
+
+  if (entryTime < 0.0f) {
+    hit.time = 0.0f;
+    float length = glm::length(displacement);
+    hit.normal = length > 0.0f ? -displacement / length : glm::vec3(0.0f);
+  } else {
+    hit.time = entryTime;
+    hit.normal = entryNormal;
+  }
+  return true;
+}
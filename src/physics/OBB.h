@@ -0,0 +1,43 @@
+#pragma once
+
+#include "./AABB.h"
+#include "./SweptAABB.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Oriented bounding box in world space
+struct OBB {
+  glm::vec3 center;
+  glm::vec3 halfExtents;
+  // Columns are the box's local axes in world space
+  glm::mat3 axes;
+
+  OBB(const glm::vec3 &_center = glm::vec3(0.0f),
+      const glm::vec3 &_halfExtents = glm::vec3(0.0f),
+      const glm::quat &orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+
+  // Smallest axis-aligned box enclosing this one
+  AABB bounds() const;
+  // Box grown by margin on every side
+  OBB fattened(float margin) const;
+
+  // Slab test in the box's frame. On a hit within [0, maxDistance] stores
+  // the entry distance along direction and the normal of the face entered.
+  // A ray starting inside hits at distance 0 with normal -direction.
+  bool raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+               float maxDistance, float &distance, glm::vec3 &normal) const;
+};
+
+// Separating-axis test over the 15 candidate axes of two boxes. If they
+// overlap (touching counts), stores the axis of least penetration as normal,
+// pointing from b towards a, and the penetration depth along it. Face axes
+// are preferred over edge axes of about the same depth so resting contacts
+// keep a stable normal.
+bool intersectOBB(const OBB &a, const OBB &b, glm::vec3 &normal,
+                  float &depth);
+
+// Continuous test of a box moving by displacement against a stationary
+// target, over the same 15 axes. Boxes that already overlap at the start
+// hit at time 0 with normal -displacement.
+bool sweepOBB(const OBB &moving, const glm::vec3 &displacement,
+              const OBB &target, SweepHit &hit);
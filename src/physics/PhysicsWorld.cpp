@@ -0,0 +1,169 @@
+#include "PhysicsWorld.h"
+#include "./DynamicTreeBroadphase.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+// Slack around moving colliders' broadphase bounds
+const float BROADPHASE_MARGIN = 0.1f;
+// Queries per job when casting in parallel
+const size_t QUERY_GRAIN_SIZE = 64;
+
+// Infinite or NaN distances would overflow the sweeps, negative ones can't
+// hit anything
+bool isValidDistance(float maxDistance) {
+  return std::isfinite(maxDistance) && maxDistance >= 0.0f;
+}
+} // unnamed namespace
+
+PhysicsWorld::PhysicsWorld(std::unique_ptr<Broadphase> _broadphase)
+    : broadphase(std::move(_broadphase)) {
+  if (!broadphase) {
+    broadphase = std::make_unique<DynamicTreeBroadphase>(BROADPHASE_MARGIN);
+  }
+}
+
+void PhysicsWorld::addCollider(EntityID entity, const OBB &box,
+                               bool isStatic) {
+  boxes[entity] = box;
+  broadphase->insertProxy(entity, box.bounds(), isStatic);
+}
+
+void PhysicsWorld::moveCollider(EntityID entity, const OBB &box) {
+  boxes[entity] = box;
+  broadphase->moveProxy(entity, box.bounds());
+}
+
+void PhysicsWorld::moveCollider(EntityID entity, const OBB &box,
+                                const AABB &proxyBounds) {
+  boxes[entity] = box;
+  broadphase->moveProxy(entity, proxyBounds);
+}
+
+void PhysicsWorld::removeCollider(EntityID entity) {
+  boxes.erase(entity);
+  broadphase->removeProxy(entity);
+}
+
+bool PhysicsWorld::hasCollider(EntityID entity) const {
+  return boxes.count(entity) > 0;
+}
+
+Broadphase &PhysicsWorld::getBroadphase() { return *broadphase; }
+
+const Broadphase &PhysicsWorld::getBroadphase() const { return *broadphase; }
+
+bool PhysicsWorld::raycast(const glm::vec3 &origin,
+                           const glm::vec3 &direction, float maxDistance,
+                           QueryHit &hit, EntityID ignored) const {
+  hit = QueryHit();
+  if (!isValidDistance(maxDistance)) {
+    return false;
+  }
+  broadphase->raycast(
+      origin, direction, maxDistance, [&](const RaycastHit &candidate) {
+        auto box = boxes.find(candidate.entity);
+        float distance;
+        glm::vec3 normal;
+        // maxDistance is clipped to the best hit, so any hit is nearer
+        if (candidate.entity != ignored && box != boxes.end() &&
+            box->second.raycast(origin, direction, maxDistance, distance,
+                                normal)) {
+          hit = {candidate.entity, distance, normal};
+          maxDistance = distance;
+        }
+        return maxDistance;
+      });
+  return hit.entity != INVALID_ENTITY;
+}
+
+bool PhysicsWorld::sphereCast(const glm::vec3 &origin, float radius,
+                              const glm::vec3 &direction, float maxDistance,
+                              QueryHit &hit, EntityID ignored) const {
+  hit = QueryHit();
+  if (!isValidDistance(maxDistance)) {
+    return false;
+  }
+  // A ray against each box grown by the radius
+  broadphase->sweepBox(
+      origin, glm::vec3(radius), direction, maxDistance,
+      [&](const RaycastHit &candidate) {
+        auto box = boxes.find(candidate.entity);
+        float distance;
+        glm::vec3 normal;
+        if (candidate.entity != ignored && box != boxes.end() &&
+            box->second.fattened(radius).raycast(origin, direction,
+                                                 maxDistance, distance,
+                                                 normal)) {
+          hit = {candidate.entity, distance, normal};
+          maxDistance = distance;
+        }
+        return maxDistance;
+      });
+  return hit.entity != INVALID_ENTITY;
+}
+
+bool PhysicsWorld::boxCast(const OBB &box, const glm::vec3 &direction,
+                           float maxDistance, QueryHit &hit,
+                           EntityID ignored) const {
+  hit = QueryHit();
+  if (!isValidDistance(maxDistance)) {
+    return false;
+  }
+  // Sweeps cover the whole distance, the broadphase walk is clipped to the
+  // best hit so far
+  const glm::vec3 displacement = direction * maxDistance;
+  const float sweepDistance = maxDistance;
+  AABB bounds = box.bounds();
+  broadphase->sweepBox(
+      bounds.center(), bounds.extents(), direction, maxDistance,
+      [&](const RaycastHit &candidate) {
+        auto target = boxes.find(candidate.entity);
+        SweepHit sweep;
+        if (candidate.entity != ignored && target != boxes.end() &&
+            sweepOBB(box, displacement, target->second, sweep) &&
+            sweep.time * sweepDistance < maxDistance) {
+          hit = {candidate.entity, sweep.time * sweepDistance, sweep.normal};
+          maxDistance = hit.distance;
+        }
+        return maxDistance;
+      });
+  return hit.entity != INVALID_ENTITY;
+}
+
+void PhysicsWorld::overlapBox(const OBB &box, std::vector<EntityID> &results,
+                              EntityID ignored) const {
+  // Candidates are appended to results and filtered in place
+  size_t first = results.size();
+  broadphase->query(box.bounds(), results);
+  auto rejected = [&](EntityID entity) {
+    auto other = boxes.find(entity);
+    glm::vec3 normal;
+    float depth;
+    return entity == ignored || other == boxes.end() ||
+           !intersectOBB(box, other->second, normal, depth);
+  };
+  results.erase(
+      std::remove_if(results.begin() + first, results.end(), rejected),
+      results.end());
+}
+
+void PhysicsWorld::castBatch(JobSystem &jobSystem,
+                             const std::vector<CastQuery> &queries,
+                             std::vector<QueryHit> &hits) const {
+  hits.resize(queries.size());
+  jobSystem.parallelFor(
+      queries.size(), QUERY_GRAIN_SIZE, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          const CastQuery &query = queries[i];
+          if (query.radius > 0.0f) {
+            sphereCast(query.origin, query.radius, query.direction,
+                       query.maxDistance, hits[i], query.ignored);
+          } else {
+            raycast(query.origin, query.direction, query.maxDistance,
+                    hits[i], query.ignored);
+          }
+        }
+      });
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../core/Entity.h"
+#include "../core/JobSystem.h"
+#include "./AABB.h"
+#include "./Broadphase.h"
+#include "./OBB.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Result of a scene query
+struct QueryHit {
+  // INVALID_ENTITY when nothing was hit
+  EntityID entity = INVALID_ENTITY;
+  // Distance travelled along the query direction before the hit
+  float distance = 0.0f;
+  // Surface normal at the hit, facing the query
+  glm::vec3 normal = glm::vec3(0.0f);
+};
+
+// One ray or sphere cast of a batch
+struct CastQuery {
+  glm::vec3 origin;
+  glm::vec3 direction;
+  float maxDistance;
+  // 0 casts a ray
+  float radius = 0.0f;
+  // Usually the entity casting
+  EntityID ignored = INVALID_ENTITY;
+};
+
+// The collision scene: an oriented box per collider, indexed by a
+// broadphase. Answers ray, shape and overlap queries against the exact
+// boxes, visiting only the colliders the broadphase reports. Queries are
+// const and safe to run from several threads at once, as long as nothing
+// moves colliders meanwhile. Casts need a finite, non-negative maxDistance;
+// with any other value they report no hit.
+class PhysicsWorld {
+public:
+  // Uses a DynamicTreeBroadphase unless another broadphase is given
+  explicit PhysicsWorld(std::unique_ptr<Broadphase> _broadphase = nullptr);
+
+  void addCollider(EntityID entity, const OBB &box, bool isStatic);
+  void moveCollider(EntityID entity, const OBB &box);
+  // Moves a collider whose broadphase proxy should cover more than its box,
+  // like the box's whole motion over a step. proxyBounds must contain the
+  // box.
+  void moveCollider(EntityID entity, const OBB &box, const AABB &proxyBounds);
+  void removeCollider(EntityID entity);
+  bool hasCollider(EntityID entity) const;
+  Broadphase &getBroadphase();
+  const Broadphase &getBroadphase() const;
+
+  // Nearest collider hit by a ray. direction must be normalized.
+  bool raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+               float maxDistance, QueryHit &hit,
+               EntityID ignored = INVALID_ENTITY) const;
+  // Nearest collider hit by a sphere moving along direction. Box corners
+  // are treated as square, so hits near edges can come slightly early.
+  bool sphereCast(const glm::vec3 &origin, float radius,
+                  const glm::vec3 &direction, float maxDistance,
+                  QueryHit &hit, EntityID ignored = INVALID_ENTITY) const;
+  // Nearest collider hit by a box moving along direction
+  bool boxCast(const OBB &box, const glm::vec3 &direction, float maxDistance,
+               QueryHit &hit, EntityID ignored = INVALID_ENTITY) const;
+  // Appends every collider overlapping box to results
+  void overlapBox(const OBB &box, std::vector<EntityID> &results,
+                  EntityID ignored = INVALID_ENTITY) const;
+
+  // Runs every query on the job system; hits[i] holds the result of
+  // queries[i]
+  void castBatch(JobSystem &jobSystem, const std::vector<CastQuery> &queries,
+                 std::vector<QueryHit> &hits) const;
+
+private:
+  std::unique_ptr<Broadphase> broadphase;
+  std::unordered_map<EntityID, OBB> boxes;
+};
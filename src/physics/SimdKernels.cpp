@@ -0,0 +1,162 @@
+#include "SimdKernels.h"
+#include <algorithm>
+#include <atomic>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PHYSICS_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+std::atomic<SimdLevel> &simdLevel() {
+  static std::atomic<SimdLevel> level{supportedSimdLevel()};
+  return level;
+}
+
+size_t overlapScalar(const AABB &aabb, const AABBBatch &batch, size_t begin,
+                     uint32_t *hits) {
+  size_t hitCount = 0;
+  for (size_t i = begin; i < batch.size(); ++i) {
+    if (aabb.max.x >= batch.minX[i] && batch.maxX[i] >= aabb.min.x &&
+        aabb.max.y >= batch.minY[i] && batch.maxY[i] >= aabb.min.y &&
+        aabb.max.z >= batch.minZ[i] && batch.maxZ[i] >= aabb.min.z) {
+      hits[hitCount++] = static_cast<uint32_t>(i);
+    }
+  }
+  return hitCount;
+}
+
+#ifdef PHYSICS_SIMD_X86
+// Appends the lanes set in mask, offset by base, to hits
+size_t appendHits(int mask, size_t base, uint32_t *hits) {
+  size_t hitCount = 0;
+  while (mask) {
+    int lane = __builtin_ctz(mask);
+    hits[hitCount++] = static_cast<uint32_t>(base + lane);
+    mask &= mask - 1;
+  }
+  return hitCount;
+}
+
+__attribute__((target("sse2"))) size_t
+overlapSSE(const AABB &aabb, const AABBBatch &batch, uint32_t *hits) {
+  const __m128 minX = _mm_set1_ps(aabb.min.x);
+  const __m128 minY = _mm_set1_ps(aabb.min.y);
+  const __m128 minZ = _mm_set1_ps(aabb.min.z);
+  const __m128 maxX = _mm_set1_ps(aabb.max.x);
+  const __m128 maxY = _mm_set1_ps(aabb.max.y);
+  const __m128 maxZ = _mm_set1_ps(aabb.max.z);
+
+  size_t hitCount = 0;
+  size_t i = 0;
+  for (; i + 4 <= batch.size(); i += 4) {
+    __m128 x = _mm_and_ps(_mm_cmpge_ps(maxX, _mm_loadu_ps(&batch.minX[i])),
+                          _mm_cmpge_ps(_mm_loadu_ps(&batch.maxX[i]), minX));
+    __m128 y = _mm_and_ps(_mm_cmpge_ps(maxY, _mm_loadu_ps(&batch.minY[i])),
+                          _mm_cmpge_ps(_mm_loadu_ps(&batch.maxY[i]), minY));
+    __m128 z = _mm_and_ps(_mm_cmpge_ps(maxZ, _mm_loadu_ps(&batch.minZ[i])),
+                          _mm_cmpge_ps(_mm_loadu_ps(&batch.maxZ[i]), minZ));
+    int mask = _mm_movemask_ps(_mm_and_ps(x, _mm_and_ps(y, z)));
+    hitCount += appendHits(mask, i, hits + hitCount);
+  }
+  return hitCount + overlapScalar(aabb, batch, i, hits + hitCount);
+}
+
+__attribute__((target("avx2"))) size_t
+overlapAVX2(const AABB &aabb, const AABBBatch &batch, uint32_t *hits) {
+  const __m256 minX = _mm256_set1_ps(aabb.min.x);
+  const __m256 minY = _mm256_set1_ps(aabb.min.y);
+  const __m256 minZ = _mm256_set1_ps(aabb.min.z);
+  const __m256 maxX = _mm256_set1_ps(aabb.max.x);
+  const __m256 maxY = _mm256_set1_ps(aabb.max.y);
+  const __m256 maxZ = _mm256_set1_ps(aabb.max.z);
+
+  size_t hitCount = 0;
+  size_t i = 0;
+  for (; i + 8 <= batch.size(); i += 8) {
+    __m256 x = _mm256_and_ps(
+        _mm256_cmp_ps(maxX, _mm256_loadu_ps(&batch.minX[i]), _CMP_GE_OQ),
+        _mm256_cmp_ps(_mm256_loadu_ps(&batch.maxX[i]), minX, _CMP_GE_OQ));
+    __m256 y = _mm256_and_ps(
+        _mm256_cmp_ps(maxY, _mm256_loadu_ps(&batch.minY[i]), _CMP_GE_OQ),
+        _mm256_cmp_ps(_mm256_loadu_ps(&batch.maxY[i]), minY, _CMP_GE_OQ));
+    __m256 z = _mm256_and_ps(
+        _mm256_cmp_ps(maxZ, _mm256_loadu_ps(&batch.minZ[i]), _CMP_GE_OQ),
+        _mm256_cmp_ps(_mm256_loadu_ps(&batch.maxZ[i]), minZ, _CMP_GE_OQ));
+    int mask = _mm256_movemask_ps(_mm256_and_ps(x, _mm256_and_ps(y, z)));
+    hitCount += appendHits(mask, i, hits + hitCount);
+  }
+  return hitCount + overlapScalar(aabb, batch, i, hits + hitCount);
+}
+#endif
+} // unnamed namespace
+
+void AABBBatch::clear() {
+  for (auto *column : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+    column->clear();
+  }
+}
+
+void AABBBatch::resize(size_t count) {
+  for (auto *column : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+    column->resize(count);
+  }
+}
+
+void AABBBatch::push_back(const AABB &aabb) {
+  minX.push_back(aabb.min.x);
+  minY.push_back(aabb.min.y);
+  minZ.push_back(aabb.min.z);
+  maxX.push_back(aabb.max.x);
+  maxY.push_back(aabb.max.y);
+  maxZ.push_back(aabb.max.z);
+}
+
+void AABBBatch::set(size_t index, const AABB &aabb) {
+  minX[index] = aabb.min.x;
+  minY[index] = aabb.min.y;
+  minZ[index] = aabb.min.z;
+  maxX[index] = aabb.max.x;
+  maxY[index] = aabb.max.y;
+  maxZ[index] = aabb.max.z;
+}
+
+AABB AABBBatch::at(size_t index) const {
+  return AABB(glm::vec3(minX[index], minY[index], minZ[index]),
+              glm::vec3(maxX[index], maxY[index], maxZ[index]));
+}
+
+size_t AABBBatch::size() const { return minX.size(); }
+
+size_t overlapBatch(const AABB &aabb, const AABBBatch &batch, uint32_t *hits) {
+#ifdef PHYSICS_SIMD_X86
+  switch (activeSimdLevel()) {
+  case SimdLevel::AVX2:
+    return overlapAVX2(aabb, batch, hits);
+  case SimdLevel::SSE:
+    return overlapSSE(aabb, batch, hits);
+  case SimdLevel::Scalar:
+    break;
+  }
+#endif
+  return overlapScalar(aabb, batch, 0, hits);
+}
+
+SimdLevel supportedSimdLevel() {
+#ifdef PHYSICS_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return SimdLevel::AVX2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return SimdLevel::SSE;
+  }
+#endif
+  return SimdLevel::Scalar;
+}
+
+SimdLevel activeSimdLevel() { return simdLevel().load(); }
+
+void setSimdLevel(SimdLevel level) {
+  simdLevel().store(std::min(level, supportedSimdLevel()));
+}
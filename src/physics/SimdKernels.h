@@ -0,0 +1,36 @@
+#pragma once
+
+#include "./AABB.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Vectorized physics kernels over structure-of-arrays data. The widest
+// instruction set the CPU supports is picked at runtime (AVX2: 8 lanes,
+// SSE: 4 lanes), with a scalar fallback on other architectures. Every level
+// performs the same operations in the same order.
+enum class SimdLevel { Scalar, SSE, AVX2 };
+
+// Boxes stored one coordinate per array
+struct AABBBatch {
+  std::vector<float> minX, minY, minZ;
+  std::vector<float> maxX, maxY, maxZ;
+
+  void clear();
+  void resize(size_t count);
+  void push_back(const AABB &aabb);
+  void set(size_t index, const AABB &aabb);
+  AABB at(size_t index) const;
+  size_t size() const;
+};
+
+// Tests aabb against every box in the batch. Writes the indices of the
+// overlapping boxes to hits (which needs room for batch.size() entries) and
+// returns how many there are. Touching boxes overlap, like AABB::overlaps.
+size_t overlapBatch(const AABB &aabb, const AABBBatch &batch, uint32_t *hits);
+
+SimdLevel supportedSimdLevel();
+SimdLevel activeSimdLevel();
+// Restricts the kernels to at most level, e.g. to compare against the scalar
+// path. Levels the CPU lacks are never used.
+void setSimdLevel(SimdLevel level);
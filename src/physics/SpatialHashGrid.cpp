@@ -0,0 +1,391 @@
+#include "SpatialHashGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+// Cell coordinates are kept within the 21 bits per axis of a cell key
+const int CELL_LIMIT = 1 << 20;
+// Proxies touching more cells than this aren't registered in the cells
+const int64_t MAX_PROXY_CELLS = 1024;
+
+// Marks the proxies the current query already visited. Kept per thread so
+// const queries can still run concurrently, and only cleared when the stamp
+// wraps around.
+struct VisitedProxies {
+  std::vector<uint32_t> stamps;
+  uint32_t stamp = 0;
+
+  uint32_t begin(size_t proxyCount) {
+    if (++stamp == 0) {
+      std::fill(stamps.begin(), stamps.end(), 0u);
+      stamp = 1;
+    }
+    if (stamps.size() < proxyCount) {
+      stamps.resize(proxyCount, 0u);
+    }
+    return stamp;
+  }
+
+  // True the first time the query with the given stamp visits the proxy
+  bool visit(size_t proxy, uint32_t queryStamp) {
+    if (stamps[proxy] == queryStamp) {
+      return false;
+    }
+    stamps[proxy] = queryStamp;
+    return true;
+  }
+};
+
+thread_local VisitedProxies visited;
+
+// Cell of a coordinate already divided by the cell size, clamped to the
+// cells a key can address. NaN ends up at the lower limit.
+int toCell(float coordinate) {
+  return int(std::max(float(-CELL_LIMIT),
+                      std::min(std::floor(coordinate), float(CELL_LIMIT - 1))));
+}
+
+// Distances at which a ray enters and leaves a box, false if it misses
+bool clipRay(const AABB &box, const glm::vec3 &origin,
+             const glm::vec3 &direction, float &tEnter, float &tExit) {
+  tEnter = -std::numeric_limits<float>::infinity();
+  tExit = std::numeric_limits<float>::infinity();
+  for (int axis = 0; axis < 3; ++axis) {
+    if (direction[axis] == 0.0f) {
+      if (origin[axis] < box.min[axis] || origin[axis] > box.max[axis]) {
+        return false;
+      }
+      continue;
+    }
+    float t1 = (box.min[axis] - origin[axis]) / direction[axis];
+    float t2 = (box.max[axis] - origin[axis]) / direction[axis];
+    tEnter = std::max(tEnter, std::min(t1, t2));
+    tExit = std::min(tExit, std::max(t1, t2));
+  }
+  return tEnter <= tExit && tExit >= 0.0f;
+}
+} // unnamed namespace
+
+bool SpatialHashGrid::CellRange::operator==(const CellRange &other) const {
+  return min == other.min && max == other.max;
+}
+
+SpatialHashGrid::SpatialHashGrid(float _cellSize)
+    : cellSize(_cellSize), inverseCellSize(1.0f / _cellSize),
+      occupied{glm::ivec3(CELL_LIMIT), glm::ivec3(-CELL_LIMIT)} {}
+
+void SpatialHashGrid::insertProxy(EntityID entity, const AABB &aabb,
+                                  bool isStatic) {
+  if (hasProxy(entity)) {
+    moveProxy(entity, aabb);
+    return;
+  }
+
+  size_t index;
+  if (!freeProxies.empty()) {
+    index = freeProxies.back();
+    freeProxies.pop_back();
+  } else {
+    index = proxies.size();
+    proxies.emplace_back();
+  }
+
+  Proxy &proxy = proxies[index];
+  proxy.entity = entity;
+  proxy.aabb = aabb;
+  proxy.cells = cellRange(aabb);
+  proxy.isStatic = isStatic;
+  proxyByEntity[entity] = index;
+  addToCells(index, proxy.cells);
+}
+
+void SpatialHashGrid::moveProxy(EntityID entity, const AABB &aabb) {
+  auto it = proxyByEntity.find(entity);
+  if (it == proxyByEntity.end()) {
+    return;
+  }
+
+  Proxy &proxy = proxies[it->second];
+  proxy.aabb = aabb;
+
+  // Only re-bucket when the proxy crossed into different cells
+  CellRange range = cellRange(aabb);
+  if (!(range == proxy.cells)) {
+    removeFromCells(it->second, proxy.cells);
+    proxy.cells = range;
+    addToCells(it->second, range);
+  }
+}
+
+void SpatialHashGrid::removeProxy(EntityID entity) {
+  auto it = proxyByEntity.find(entity);
+  if (it == proxyByEntity.end()) {
+    return;
+  }
+
+  removeFromCells(it->second, proxies[it->second].cells);
+  freeProxies.push_back(it->second);
+  proxyByEntity.erase(it);
+}
+
+bool SpatialHashGrid::hasProxy(EntityID entity) const {
+  return proxyByEntity.count(entity) > 0;
+}
+
+void SpatialHashGrid::clear() {
+  proxies.clear();
+  freeProxies.clear();
+  proxyByEntity.clear();
+  cells.clear();
+  oversizedProxies.clear();
+  occupied = {glm::ivec3(CELL_LIMIT), glm::ivec3(-CELL_LIMIT)};
+}
+
+void SpatialHashGrid::query(const AABB &aabb,
+                            std::vector<EntityID> &results) const {
+  for (size_t index : oversizedProxies) {
+    if (proxies[index].aabb.overlaps(aabb)) {
+      results.push_back(proxies[index].entity);
+    }
+  }
+
+  // Cells outside the occupied bounds are empty
+  CellRange range = cellRange(aabb);
+  range.min = glm::max(range.min, occupied.min);
+  range.max = glm::min(range.max, occupied.max);
+  int64_t count = cellCount(range);
+  if (count == 0) {
+    return;
+  }
+
+  // Proxies spanning several cells are found once per cell
+  uint32_t stamp = visited.begin(proxies.size());
+  auto testCell = [&](const std::vector<size_t> &cell) {
+    for (size_t index : cell) {
+      if (visited.visit(index, stamp) && proxies[index].aabb.overlaps(aabb)) {
+        results.push_back(proxies[index].entity);
+      }
+    }
+  };
+
+  // A range larger than the number of cells in use scans those instead
+  if (count > int64_t(cells.size())) {
+    for (const auto &[key, cell] : cells) {
+      glm::ivec3 coordinates = cellCoordinates(key);
+      if (glm::all(glm::greaterThanEqual(coordinates, range.min)) &&
+          glm::all(glm::lessThanEqual(coordinates, range.max))) {
+        testCell(cell);
+      }
+    }
+    return;
+  }
+
+  for (int x = range.min.x; x <= range.max.x; ++x) {
+    for (int y = range.min.y; y <= range.max.y; ++y) {
+      for (int z = range.min.z; z <= range.max.z; ++z) {
+        auto cell = cells.find(cellKey(x, y, z));
+        if (cell != cells.end()) {
+          testCell(cell->second);
+        }
+      }
+    }
+  }
+}
+
+void SpatialHashGrid::sweepBox(const glm::vec3 &origin,
+                               const glm::vec3 &extent,
+                               const glm::vec3 &direction, float maxDistance,
+                               const RaycastCallback &callback) const {
+  // Reports a hit, false once the callback stopped the cast
+  auto testProxy = [&](size_t index) {
+    const AABB &aabb = proxies[index].aabb;
+    float distance;
+    if (AABB(aabb.min - extent, aabb.max + extent)
+            .raycast(origin, direction, maxDistance, distance)) {
+      maxDistance = callback({proxies[index].entity, distance});
+      return maxDistance > 0.0f;
+    }
+    return true;
+  };
+
+  for (size_t index : oversizedProxies) {
+    if (!testProxy(index)) {
+      return;
+    }
+  }
+
+  if (glm::any(glm::isnan(direction)) || cellCount(occupied) == 0) {
+    return;
+  }
+
+  // The box touches cells up to reach away from the one its center is in
+  glm::ivec3 reach;
+  for (int axis = 0; axis < 3; ++axis) {
+    reach[axis] =
+        std::max(0, toCell(std::ceil(extent[axis] * inverseCellSize)));
+  }
+  uint32_t stamp = visited.begin(proxies.size());
+  if (cellCount({-reach, reach}) > int64_t(cells.size())) {
+    // Boxes wider than the cells in use test every proxy instead
+    for (const auto &[key, cell] : cells) {
+      for (size_t index : cell) {
+        if (visited.visit(index, stamp) && !testProxy(index)) {
+          return;
+        }
+      }
+    }
+    return;
+  }
+
+  // Only the part of the ray within reach of the occupied cells is walked,
+  // which also bounds the walk when maxDistance is infinite
+  CellRange walked{occupied.min - reach, occupied.max + reach};
+  AABB bounds(glm::vec3(walked.min) * cellSize,
+              glm::vec3(walked.max + 1) * cellSize);
+  float tEnter, tExit;
+  if (!clipRay(bounds, origin, direction, tEnter, tExit) ||
+      tEnter > maxDistance) {
+    return;
+  }
+  glm::vec3 start =
+      (origin + direction * std::max(tEnter, 0.0f)) * inverseCellSize;
+  glm::ivec3 cell =
+      glm::clamp(glm::ivec3(toCell(start.x), toCell(start.y), toCell(start.z)),
+                 walked.min, walked.max);
+
+  // Walk the cells the ray passes through in order (Amanatides-Woo). tMax
+  // is the distance at which the ray crosses into the next cell on each
+  // axis, tDelta the distance between crossings.
+  glm::ivec3 step(0);
+  glm::vec3 tMax(std::numeric_limits<float>::infinity());
+  glm::vec3 tDelta(std::numeric_limits<float>::infinity());
+  for (int axis = 0; axis < 3; ++axis) {
+    if (direction[axis] > 0.0f) {
+      step[axis] = 1;
+      tMax[axis] =
+          ((cell[axis] + 1) * cellSize - origin[axis]) / direction[axis];
+      tDelta[axis] = cellSize / direction[axis];
+    } else if (direction[axis] < 0.0f) {
+      step[axis] = -1;
+      tMax[axis] = (cell[axis] * cellSize - origin[axis]) / direction[axis];
+      tDelta[axis] = -cellSize / direction[axis];
+    }
+  }
+
+  // Proxies spanning several cells are tested in the first one only
+  while (true) {
+    glm::ivec3 low = glm::max(cell - reach, occupied.min);
+    glm::ivec3 high = glm::min(cell + reach, occupied.max);
+    for (int x = low.x; x <= high.x; ++x) {
+      for (int y = low.y; y <= high.y; ++y) {
+        for (int z = low.z; z <= high.z; ++z) {
+          auto found = cells.find(cellKey(x, y, z));
+          if (found == cells.end()) {
+            continue;
+          }
+          for (size_t index : found->second) {
+            if (visited.visit(index, stamp) && !testProxy(index)) {
+              return;
+            }
+          }
+        }
+      }
+    }
+
+    // Proxies not seen yet are only entered past this cell, so stop once
+    // the ray is clipped or leaves the walked cells before it. A zero
+    // direction never leaves the origin's cell.
+    int axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2)
+                               : (tMax.y < tMax.z ? 1 : 2);
+    if (step[axis] == 0 || tMax[axis] > std::min(maxDistance, tExit)) {
+      return;
+    }
+    cell[axis] += step[axis];
+    if (cell[axis] < walked.min[axis] || cell[axis] > walked.max[axis]) {
+      return;
+    }
+    tMax[axis] += tDelta[axis];
+  }
+}
+
+SpatialHashGrid::CellRange SpatialHashGrid::cellRange(const AABB &aabb) const {
+  glm::vec3 min = aabb.min * inverseCellSize;
+  glm::vec3 max = aabb.max * inverseCellSize;
+  CellRange range;
+  range.min = glm::ivec3(toCell(min.x), toCell(min.y), toCell(min.z));
+  range.max = glm::ivec3(toCell(max.x), toCell(max.y), toCell(max.z));
+  return range;
+}
+
+int64_t SpatialHashGrid::cellKey(int x, int y, int z) {
+  // cellRange() keeps coordinates within 21 bits per axis
+  const int64_t mask = (int64_t(1) << 21) - 1;
+  return (int64_t(x) & mask) | ((int64_t(y) & mask) << 21) |
+         ((int64_t(z) & mask) << 42);
+}
+
+glm::ivec3 SpatialHashGrid::cellCoordinates(int64_t key) {
+  glm::ivec3 coordinates;
+  for (int axis = 0; axis < 3; ++axis) {
+    int value = int((key >> (21 * axis)) & ((int64_t(1) << 21) - 1));
+    coordinates[axis] = value >= CELL_LIMIT ? value - 2 * CELL_LIMIT : value;
+  }
+  return coordinates;
+}
+
+int64_t SpatialHashGrid::cellCount(const CellRange &range) {
+  int64_t count = 1;
+  for (int axis = 0; axis < 3; ++axis) {
+    if (range.max[axis] < range.min[axis]) {
+      return 0;
+    }
+    // Saturates, the full key range would overflow
+    int64_t width = int64_t(range.max[axis]) - range.min[axis] + 1;
+    count = std::min(count * width, std::numeric_limits<int64_t>::max() /
+                                        (2 * int64_t(CELL_LIMIT)));
+  }
+  return count;
+}
+
+void SpatialHashGrid::addToCells(size_t proxy, const CellRange &range) {
+  proxies[proxy].isOversized = cellCount(range) > MAX_PROXY_CELLS;
+  if (proxies[proxy].isOversized) {
+    oversizedProxies.push_back(proxy);
+    return;
+  }
+
+  occupied.min = glm::min(occupied.min, range.min);
+  occupied.max = glm::max(occupied.max, range.max);
+  for (int x = range.min.x; x <= range.max.x; ++x) {
+    for (int y = range.min.y; y <= range.max.y; ++y) {
+      for (int z = range.min.z; z <= range.max.z; ++z) {
+        cells[cellKey(x, y, z)].push_back(proxy);
+      }
+    }
+  }
+}
+
+void SpatialHashGrid::removeFromCells(size_t proxy, const CellRange &range) {
+  if (proxies[proxy].isOversized) {
+    oversizedProxies.erase(std::find(oversizedProxies.begin(),
+                                     oversizedProxies.end(), proxy));
+    return;
+  }
+
+  for (int x = range.min.x; x <= range.max.x; ++x) {
+    for (int y = range.min.y; y <= range.max.y; ++y) {
+      for (int z = range.min.z; z <= range.max.z; ++z) {
+        auto cell = cells.find(cellKey(x, y, z));
+        if (cell == cells.end()) {
+          continue;
+        }
+        auto &list = cell->second;
+        list.erase(std::remove(list.begin(), list.end(), proxy), list.end());
+        if (list.empty()) {
+          cells.erase(cell);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "./Broadphase.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid broadphase. Every proxy is registered in each cell its AABB
+// touches, cells live in a hash map so the world is unbounded. Moving a proxy
+// only touches the cell lists when it crosses a cell boundary. Proxies
+// covering too many cells are kept in a list of their own and tested by
+// every query instead. A ray or sweep callback must not query another grid
+// on the same thread, the marks of visited proxies are kept per thread.
+class SpatialHashGrid : public Broadphase {
+public:
+  explicit SpatialHashGrid(float cellSize = 8.0f);
+
+  void insertProxy(EntityID entity, const AABB &aabb, bool isStatic) override;
+  void moveProxy(EntityID entity, const AABB &aabb) override;
+  void removeProxy(EntityID entity) override;
+  bool hasProxy(EntityID entity) const override;
+  void clear() override;
+
+  void query(const AABB &aabb, std::vector<EntityID> &results) const override;
+  void sweepBox(const glm::vec3 &origin, const glm::vec3 &extent,
+                const glm::vec3 &direction, float maxDistance,
+                const RaycastCallback &callback) const override;
+
+private:
+  struct CellRange {
+    glm::ivec3 min;
+    glm::ivec3 max;
+
+    bool operator==(const CellRange &other) const;
+  };
+
+  struct Proxy {
+    EntityID entity;
+    AABB aabb;
+    CellRange cells;
+    bool isStatic;
+    bool isOversized;
+  };
+
+  float cellSize;
+  float inverseCellSize;
+  // Proxies are never moved in memory so cells can refer to them by index
+  std::vector<Proxy> proxies;
+  std::vector<size_t> freeProxies;
+  std::unordered_map<EntityID, size_t> proxyByEntity;
+  std::unordered_map<int64_t, std::vector<size_t>> cells;
+  std::vector<size_t> oversizedProxies;
+  // Bounds of every cell used since the last clear(), queries and rays are
+  // clipped to them
+  CellRange occupied;
+
+  CellRange cellRange(const AABB &aabb) const;
+  static int64_t cellKey(int x, int y, int z);
+  static glm::ivec3 cellCoordinates(int64_t key);
+  static int64_t cellCount(const CellRange &range);
+  void addToCells(size_t proxy, const CellRange &range);
+  void removeFromCells(size_t proxy, const CellRange &range);
+};
@@ -0,0 +1,352 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+void SweepAndPrune::insertProxy(EntityID entity, const AABB &aabb,
+                                bool isStatic) {
+  if (hasProxy(entity)) {
+    moveProxy(entity, aabb);
+    return;
+  }
+
+  uint32_t index;
+  if (!freeProxies.empty()) {
+    index = freeProxies.back();
+    freeProxies.pop_back();
+  } else {
+    index = static_cast<uint32_t>(proxies.size());
+    proxies.emplace_back();
+  }
+
+  Proxy &proxy = proxies[index];
+  proxy.entity = entity;
+  proxy.aabb = aabb;
+  proxy.isStatic = isStatic;
+  proxyByEntity[entity] = index;
+  growExtent(aabb);
+
+  // Start past the end of every axis, where the box overlaps nothing, and
+  // sort it in so its overlaps are reported like any other movement
+  for (int axis = 0; axis < 3; ++axis) {
+    std::vector<Endpoint> &endpoints = axes[axis];
+    proxy.minIndex[axis] = static_cast<uint32_t>(endpoints.size());
+    endpoints.push_back({aabb.min[axis], index, false});
+    proxy.maxIndex[axis] = static_cast<uint32_t>(endpoints.size());
+    endpoints.push_back({aabb.max[axis], index, true});
+
+    siftDown(axis, proxy.minIndex[axis]);
+    siftDown(axis, proxy.maxIndex[axis]);
+  }
+}
+
+void SweepAndPrune::moveProxy(EntityID entity, const AABB &aabb) {
+  auto it = proxyByEntity.find(entity);
+  if (it == proxyByEntity.end()) {
+    return;
+  }
+
+  Proxy &proxy = proxies[it->second];
+  AABB previous = proxy.aabb;
+  proxy.aabb = aabb;
+  growExtent(aabb);
+
+  for (int axis = 0; axis < 3; ++axis) {
+    std::vector<Endpoint> &endpoints = axes[axis];
+    endpoints[proxy.minIndex[axis]].value = aabb.min[axis];
+    endpoints[proxy.maxIndex[axis]].value = aabb.max[axis];
+
+    // Sort the leading endpoint first so it never blocks the other one
+    if (aabb.max[axis] > previous.max[axis]) {
+      sift(axis, proxy.maxIndex[axis]);
+      sift(axis, proxy.minIndex[axis]);
+    } else {
+      sift(axis, proxy.minIndex[axis]);
+      sift(axis, proxy.maxIndex[axis]);
+    }
+  }
+}
+
+void SweepAndPrune::removeProxy(EntityID entity) {
+  auto it = proxyByEntity.find(entity);
+  if (it == proxyByEntity.end()) {
+    return;
+  }
+
+  uint32_t index = it->second;
+  Proxy &proxy = proxies[index];
+  while (!proxy.pairs.empty()) {
+    removePair(index, proxy.pairs.back());
+  }
+
+  // Erasing the endpoints would shift the rest of every axis. Mark them
+  // instead; they still sort correctly and are skipped until compacted.
+  for (int axis = 0; axis < 3; ++axis) {
+    axes[axis][proxy.minIndex[axis]].proxy = REMOVED;
+    axes[axis][proxy.maxIndex[axis]].proxy = REMOVED;
+  }
+  removedEndpoints += 2;
+  if (removedEndpoints * 2 > axes[0].size()) {
+    compact();
+  }
+
+  freeProxies.push_back(index);
+  proxyByEntity.erase(it);
+}
+
+bool SweepAndPrune::hasProxy(EntityID entity) const {
+  return proxyByEntity.count(entity) > 0;
+}
+
+void SweepAndPrune::clear() {
+  for (auto &endpoints : axes) {
+    endpoints.clear();
+  }
+  proxies.clear();
+  freeProxies.clear();
+  proxyByEntity.clear();
+  pairs.clear();
+  removedPairs.clear();
+  removedEndpoints = 0;
+  maxExtentX = 0.0f;
+}
+
+void SweepAndPrune::query(const AABB &aabb,
+                          std::vector<EntityID> &results) const {
+  // Every box that can overlap starts at most maxExtentX before aabb on the
+  // X axis, and before aabb ends. Round the start down so boxes that only
+  // touch aabb are still found.
+  const std::vector<Endpoint> &endpoints = axes[0];
+  float start = std::nextafter(aabb.min.x - maxExtentX,
+                               -std::numeric_limits<float>::infinity());
+  auto first = std::lower_bound(
+      endpoints.begin(), endpoints.end(), start,
+      [](const Endpoint &endpoint, float value) {
+        return endpoint.value < value;
+      });
+
+  for (auto it = first; it != endpoints.end(); ++it) {
+    if (it->value > aabb.max.x) {
+      break;
+    }
+    if (!it->isMax && it->proxy != REMOVED &&
+        proxies[it->proxy].aabb.overlaps(aabb)) {
+      results.push_back(proxies[it->proxy].entity);
+    }
+  }
+}
+
+void SweepAndPrune::sweepBox(const glm::vec3 &origin,
+                             const glm::vec3 &extent,
+                             const glm::vec3 &direction, float maxDistance,
+                             const RaycastCallback &callback) const {
+  // Reports a hit, false once the callback stopped the cast
+  auto testProxy = [&](uint32_t index) {
+    const AABB &aabb = proxies[index].aabb;
+    float distance;
+    if (AABB(aabb.min - extent, aabb.max + extent)
+            .raycast(origin, direction, maxDistance, distance)) {
+      maxDistance = callback({proxies[index].entity, distance});
+      return maxDistance > 0.0f;
+    }
+    return true;
+  };
+
+  // Boxes are walked in the order the ray reaches them on the X axis, so the
+  // walk ends as soon as the ray is clipped before the next one. Boxes
+  // holding the origin start at most maxExtentX behind it. The swept box
+  // reaches extent.x further on both sides.
+  const std::vector<Endpoint> &endpoints = axes[0];
+  if (direction.x > 0.0f) {
+    float start = std::nextafter(origin.x - extent.x - maxExtentX,
+                                 -std::numeric_limits<float>::infinity());
+    auto it = std::lower_bound(endpoints.begin(), endpoints.end(), start,
+                               [](const Endpoint &endpoint, float value) {
+                                 return endpoint.value < value;
+                               });
+    for (; it != endpoints.end() &&
+           it->value <= origin.x + extent.x + direction.x * maxDistance;
+         ++it) {
+      if (!it->isMax && it->proxy != REMOVED && !testProxy(it->proxy)) {
+        return;
+      }
+    }
+  } else if (direction.x < 0.0f) {
+    // Mirrored, walking max endpoints down from past the origin
+    float start = std::nextafter(origin.x + extent.x + maxExtentX,
+                                 std::numeric_limits<float>::infinity());
+    auto it = std::upper_bound(endpoints.begin(), endpoints.end(), start,
+                               [](float value, const Endpoint &endpoint) {
+                                 return value < endpoint.value;
+                               });
+    while (it != endpoints.begin()) {
+      --it;
+      if (it->value < origin.x - extent.x + direction.x * maxDistance) {
+        return;
+      }
+      if (it->isMax && it->proxy != REMOVED && !testProxy(it->proxy)) {
+        return;
+      }
+    }
+  } else if (direction.x == 0.0f) {
+    // The ray never leaves the origin's X, only boxes around it can be hit
+    float start = std::nextafter(origin.x - extent.x - maxExtentX,
+                                 -std::numeric_limits<float>::infinity());
+    auto it = std::lower_bound(endpoints.begin(), endpoints.end(), start,
+                               [](const Endpoint &endpoint, float value) {
+                                 return endpoint.value < value;
+                               });
+    for (; it != endpoints.end() && it->value <= origin.x + extent.x; ++it) {
+      if (!it->isMax && it->proxy != REMOVED && !testProxy(it->proxy)) {
+        return;
+      }
+    }
+  }
+}
+
+bool SweepAndPrune::tracksPairs() const { return true; }
+
+void SweepAndPrune::pairsOf(EntityID entity,
+                            std::vector<EntityID> &results) const {
+  auto it = proxyByEntity.find(entity);
+  if (it == proxyByEntity.end()) {
+    return;
+  }
+  for (uint32_t other : proxies[it->second].pairs) {
+    results.push_back(proxies[other].entity);
+  }
+}
+
+void SweepAndPrune::takeRemovedPairs(
+    std::vector<std::pair<EntityID, EntityID>> &removed) {
+  removed.insert(removed.end(), removedPairs.begin(), removedPairs.end());
+  removedPairs.clear();
+}
+
+size_t SweepAndPrune::pairCount() const { return pairs.size(); }
+
+void SweepAndPrune::sift(int axis, uint32_t index) {
+  siftDown(axis, index);
+  siftUp(axis, index);
+}
+
+void SweepAndPrune::siftDown(int axis, uint32_t index) {
+  std::vector<Endpoint> &endpoints = axes[axis];
+  while (index > 0 && endpointLess(endpoints[index], endpoints[index - 1])) {
+    const Endpoint &moving = endpoints[index];
+    const Endpoint &passed = endpoints[index - 1];
+    if (moving.proxy != passed.proxy && passed.proxy != REMOVED) {
+      if (!moving.isMax && passed.isMax) {
+        // Min moved below the other's max: overlapping on this axis
+        if (proxies[moving.proxy].aabb.overlaps(proxies[passed.proxy].aabb)) {
+          addPair(moving.proxy, passed.proxy);
+        }
+      } else if (moving.isMax && !passed.isMax) {
+        // Max moved below the other's min: separated on this axis
+        removePair(moving.proxy, passed.proxy);
+      }
+    }
+
+    std::swap(endpoints[index], endpoints[index - 1]);
+    updateIndex(axis, index);
+    updateIndex(axis, --index);
+  }
+}
+
+void SweepAndPrune::siftUp(int axis, uint32_t index) {
+  std::vector<Endpoint> &endpoints = axes[axis];
+  while (index + 1 < endpoints.size() &&
+         endpointLess(endpoints[index + 1], endpoints[index])) {
+    const Endpoint &moving = endpoints[index];
+    const Endpoint &passed = endpoints[index + 1];
+    if (moving.proxy != passed.proxy && passed.proxy != REMOVED) {
+      if (moving.isMax && !passed.isMax) {
+        // Max moved above the other's min: overlapping on this axis
+        if (proxies[moving.proxy].aabb.overlaps(proxies[passed.proxy].aabb)) {
+          addPair(moving.proxy, passed.proxy);
+        }
+      } else if (!moving.isMax && passed.isMax) {
+        // Min moved above the other's max: separated on this axis
+        removePair(moving.proxy, passed.proxy);
+      }
+    }
+
+    std::swap(endpoints[index], endpoints[index + 1]);
+    updateIndex(axis, index);
+    updateIndex(axis, ++index);
+  }
+}
+
+void SweepAndPrune::updateIndex(int axis, uint32_t index) {
+  const Endpoint &endpoint = axes[axis][index];
+  if (endpoint.proxy == REMOVED) {
+    return;
+  }
+  Proxy &proxy = proxies[endpoint.proxy];
+  if (endpoint.isMax) {
+    proxy.maxIndex[axis] = index;
+  } else {
+    proxy.minIndex[axis] = index;
+  }
+}
+
+void SweepAndPrune::compact() {
+  for (int axis = 0; axis < 3; ++axis) {
+    std::vector<Endpoint> &endpoints = axes[axis];
+    endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(),
+                                   [](const Endpoint &endpoint) {
+                                     return endpoint.proxy == REMOVED;
+                                   }),
+                    endpoints.end());
+    for (uint32_t i = 0; i < endpoints.size(); ++i) {
+      updateIndex(axis, i);
+    }
+  }
+  removedEndpoints = 0;
+}
+
+void SweepAndPrune::growExtent(const AABB &aabb) {
+  float extent = std::nextafter(aabb.max.x - aabb.min.x,
+                                std::numeric_limits<float>::infinity());
+  maxExtentX = std::max(maxExtentX, extent);
+}
+
+void SweepAndPrune::addPair(uint32_t a, uint32_t b) {
+  // Static geometry overlapping other static geometry is of no interest
+  if (proxies[a].isStatic && proxies[b].isStatic) {
+    return;
+  }
+  if (pairs.insert(pairKey(a, b)).second) {
+    proxies[a].pairs.push_back(b);
+    proxies[b].pairs.push_back(a);
+  }
+}
+
+void SweepAndPrune::removePair(uint32_t a, uint32_t b) {
+  if (pairs.erase(pairKey(a, b)) == 0) {
+    return;
+  }
+  auto unlink = [](std::vector<uint32_t> &proxyPairs, uint32_t other) {
+    auto it = std::find(proxyPairs.begin(), proxyPairs.end(), other);
+    *it = proxyPairs.back();
+    proxyPairs.pop_back();
+  };
+  unlink(proxies[a].pairs, b);
+  unlink(proxies[b].pairs, a);
+  removedPairs.emplace_back(proxies[a].entity, proxies[b].entity);
+}
+
+uint64_t SweepAndPrune::pairKey(uint32_t a, uint32_t b) {
+  if (a > b) {
+    std::swap(a, b);
+  }
+  return (uint64_t(a) << 32) | b;
+}
+
+bool SweepAndPrune::endpointLess(const Endpoint &a, const Endpoint &b) {
+  if (a.value != b.value) {
+    return a.value < b.value;
+  }
+  return !a.isMax && b.isMax;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "./Broadphase.h"
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Sort-and-sweep broadphase. Each axis keeps a persistent sorted array of
+// box endpoints; when a proxy moves its endpoints are insertion sorted into
+// place, which is close to O(1) as bodies barely move between steps. Every
+// swap between a min and a max endpoint marks a pair starting or stopping to
+// overlap, so the set of overlapping pairs is maintained incrementally
+// instead of being recomputed.
+class SweepAndPrune : public Broadphase {
+public:
+  void insertProxy(EntityID entity, const AABB &aabb, bool isStatic) override;
+  void moveProxy(EntityID entity, const AABB &aabb) override;
+  void removeProxy(EntityID entity) override;
+  bool hasProxy(EntityID entity) const override;
+  void clear() override;
+
+  void query(const AABB &aabb, std::vector<EntityID> &results) const override;
+  void sweepBox(const glm::vec3 &origin, const glm::vec3 &extent,
+                const glm::vec3 &direction, float maxDistance,
+                const RaycastCallback &callback) const override;
+
+  bool tracksPairs() const override;
+  void pairsOf(EntityID entity, std::vector<EntityID> &results) const override;
+  void takeRemovedPairs(
+      std::vector<std::pair<EntityID, EntityID>> &removed) override;
+  size_t pairCount() const;
+
+private:
+  struct Endpoint {
+    float value;
+    uint32_t proxy;
+    bool isMax;
+  };
+
+  struct Proxy {
+    EntityID entity;
+    AABB aabb;
+    uint32_t minIndex[3];
+    uint32_t maxIndex[3];
+    bool isStatic;
+    // Proxies overlapping this one
+    std::vector<uint32_t> pairs;
+  };
+
+  // Proxy of the endpoints of removed proxies. They keep their place until
+  // enough of them pile up to be dropped in one pass.
+  static constexpr uint32_t REMOVED = ~uint32_t(0);
+
+  std::vector<Endpoint> axes[3];
+  std::vector<Proxy> proxies;
+  std::vector<uint32_t> freeProxies;
+  std::unordered_map<EntityID, uint32_t> proxyByEntity;
+  // Overlapping proxy pairs, keyed by both proxy indices
+  std::unordered_set<uint64_t> pairs;
+  std::vector<std::pair<EntityID, EntityID>> removedPairs;
+  size_t removedEndpoints = 0;
+  // Largest X extent of any proxy so far, rounded up. Bounds how far before
+  // a query box the proxies overlapping it can start.
+  float maxExtentX = 0.0f;
+
+  // Moves the endpoint at index to its sorted place, reporting the overlaps
+  // it starts or ends on the way
+  void sift(int axis, uint32_t index);
+  void siftDown(int axis, uint32_t index);
+  void siftUp(int axis, uint32_t index);
+  void updateIndex(int axis, uint32_t index);
+  // Drops the endpoints of removed proxies from every axis
+  void compact();
+  void growExtent(const AABB &aabb);
+  void addPair(uint32_t a, uint32_t b);
+  void removePair(uint32_t a, uint32_t b);
+  static uint64_t pairKey(uint32_t a, uint32_t b);
+  // Sort order on an axis; a min at the same value as a max sorts first so
+  // touching boxes count as overlapping, like AABB::overlaps
+  static bool endpointLess(const Endpoint &a, const Endpoint &b);
+};
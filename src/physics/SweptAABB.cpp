@@ -0,0 +1,47 @@
+#include "SweptAABB.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+bool sweepAABB(const AABB &moving, const glm::vec3 &displacement,
+               const AABB &target, SweepHit &hit) {
+  float entryTime = -std::numeric_limits<float>::infinity();
+  float exitTime = std::numeric_limits<float>::infinity();
+  int entryAxis = -1;
+
+  for (int axis = 0; axis < 3; ++axis) {
+    if (std::abs(displacement[axis]) < 1e-8f) {
+      // Not moving along this axis: the boxes must already overlap on it
+      if (moving.max[axis] <= target.min[axis] ||
+          moving.min[axis] >= target.max[axis]) {
+        return false;
+      }
+      continue;
+    }
+
+    // Times at which the moving box starts and stops overlapping on the axis
+    float inverse = 1.0f / displacement[axis];
+    float entry = (target.min[axis] - moving.max[axis]) * inverse;
+    float exit = (target.max[axis] - moving.min[axis]) * inverse;
+    if (entry > exit) {
+      std::swap(entry, exit);
+    }
+
+    if (entry > entryTime) {
+      entryTime = entry;
+      entryAxis = axis;
+    }
+    exitTime = std::min(exitTime, exit);
+  }
+
+  if (entryAxis < 0 || entryTime >= exitTime || entryTime < 0.0f ||
+      entryTime > 1.0f) {
+    return false;
+  }
+
+  hit.time = entryTime;
+  hit.normal = glm::vec3(0.0f);
+  hit.normal[entryAxis] = displacement[entryAxis] > 0.0f ? -1.0f : 1.0f;
+  return true;
+}
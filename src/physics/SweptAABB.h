@@ -0,0 +1,19 @@
+#pragma once
+
+#include "./AABB.h"
+#include <glm/glm.hpp>
+
+struct SweepHit {
+  // Fraction of the displacement travelled before contact, in [0, 1]
+  float time;
+  // Contact normal on the target, pointing towards the moving box
+  glm::vec3 normal;
+};
+
+// Continuous test of a box moving by displacement against a stationary
+// target. Returns false if they don't meet within the displacement, or if
+// they already overlap at the start (left to discrete resolution). Boxes
+// that only touch on an axis they don't move along are not a hit, so a body
+// can slide along a surface.
+bool sweepAABB(const AABB &moving, const glm::vec3 &displacement,
+               const AABB &target, SweepHit &hit);
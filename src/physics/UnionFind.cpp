@@ -0,0 +1,37 @@
+#include "UnionFind.h"
+#include <numeric>
+#include <utility>
+
+UnionFind::UnionFind(size_t size) { reset(size); }
+
+void UnionFind::reset(size_t size) {
+  parents.resize(size);
+  std::iota(parents.begin(), parents.end(), size_t(0));
+  ranks.assign(size, 0);
+}
+
+size_t UnionFind::find(size_t element) {
+  // Path halving: point every other node on the way at its grandparent
+  while (parents[element] != element) {
+    parents[element] = parents[parents[element]];
+    element = parents[element];
+  }
+  return element;
+}
+
+void UnionFind::unite(size_t a, size_t b) {
+  a = find(a);
+  b = find(b);
+  if (a == b) {
+    return;
+  }
+
+  // Hang the shallower tree under the deeper one
+  if (ranks[a] < ranks[b]) {
+    std::swap(a, b);
+  }
+  parents[b] = a;
+  if (ranks[a] == ranks[b]) {
+    ++ranks[a];
+  }
+}
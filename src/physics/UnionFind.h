@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Disjoint sets over the indices [0, size), used to group bodies that touch
+// into simulation islands
+class UnionFind {
+public:
+  explicit UnionFind(size_t size = 0);
+
+  void reset(size_t size);
+  // Representative of the set containing element
+  size_t find(size_t element);
+  void unite(size_t a, size_t b);
+
+private:
+  std::vector<size_t> parents;
+  std::vector<size_t> ranks;
+};
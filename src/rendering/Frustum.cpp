@@ -0,0 +1,156 @@
+#include "Frustum.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RENDERING_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+// A frustum plane along with the batch columns that hold, for each box, the
+// corner furthest along the plane's normal
+struct CullPlane {
+  glm::vec4 plane;
+  const float *x;
+  const float *y;
+  const float *z;
+};
+
+std::array<CullPlane, 6> cullPlanes(const Frustum &frustum,
+                                    const AABBBatch &batch) {
+  std::array<CullPlane, 6> cull;
+  for (size_t i = 0; i < cull.size(); ++i) {
+    const glm::vec4 &plane = frustum.planes[i];
+    cull[i].plane = plane;
+    cull[i].x = plane.x >= 0.0f ? batch.maxX.data() : batch.minX.data();
+    cull[i].y = plane.y >= 0.0f ? batch.maxY.data() : batch.minY.data();
+    cull[i].z = plane.z >= 0.0f ? batch.maxZ.data() : batch.minZ.data();
+  }
+  return cull;
+}
+
+size_t cullScalar(const std::array<CullPlane, 6> &cull, size_t begin,
+                  size_t end, uint32_t *visible) {
+  size_t visibleCount = 0;
+  for (size_t i = begin; i < end; ++i) {
+    bool inside = true;
+    for (const CullPlane &p : cull) {
+      inside = inside && p.plane.x * p.x[i] + p.plane.y * p.y[i] +
+                                 p.plane.z * p.z[i] + p.plane.w >=
+                             0.0f;
+    }
+    if (inside) {
+      visible[visibleCount++] = static_cast<uint32_t>(i);
+    }
+  }
+  return visibleCount;
+}
+
+#ifdef RENDERING_SIMD_X86
+// Appends the lanes set in mask, offset by base, to visible
+size_t appendVisible(int mask, size_t base, uint32_t *visible) {
+  size_t visibleCount = 0;
+  while (mask) {
+    int lane = __builtin_ctz(mask);
+    visible[visibleCount++] = static_cast<uint32_t>(base + lane);
+    mask &= mask - 1;
+  }
+  return visibleCount;
+}
+
+__attribute__((target("sse2"))) size_t
+cullSSE(const std::array<CullPlane, 6> &cull, size_t begin, size_t end,
+        uint32_t *visible) {
+  const __m128 zero = _mm_setzero_ps();
+  size_t visibleCount = 0;
+  size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    __m128 inside = _mm_cmpeq_ps(zero, zero);
+    for (const CullPlane &p : cull) {
+      __m128 distance =
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.plane.x), _mm_loadu_ps(p.x + i)),
+                     _mm_mul_ps(_mm_set1_ps(p.plane.y), _mm_loadu_ps(p.y + i)));
+      distance = _mm_add_ps(
+          distance, _mm_mul_ps(_mm_set1_ps(p.plane.z), _mm_loadu_ps(p.z + i)));
+      distance = _mm_add_ps(distance, _mm_set1_ps(p.plane.w));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+    }
+    int mask = _mm_movemask_ps(inside);
+    visibleCount += appendVisible(mask, i, visible + visibleCount);
+  }
+  return visibleCount + cullScalar(cull, i, end, visible + visibleCount);
+}
+
+__attribute__((target("avx2"))) size_t
+cullAVX2(const std::array<CullPlane, 6> &cull, size_t begin, size_t end,
+         uint32_t *visible) {
+  const __m256 zero = _mm256_setzero_ps();
+  size_t visibleCount = 0;
+  size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+    for (const CullPlane &p : cull) {
+      __m256 distance = _mm256_add_ps(
+          _mm256_mul_ps(_mm256_set1_ps(p.plane.x), _mm256_loadu_ps(p.x + i)),
+          _mm256_mul_ps(_mm256_set1_ps(p.plane.y), _mm256_loadu_ps(p.y + i)));
+      distance = _mm256_add_ps(
+          distance,
+          _mm256_mul_ps(_mm256_set1_ps(p.plane.z), _mm256_loadu_ps(p.z + i)));
+      distance = _mm256_add_ps(distance, _mm256_set1_ps(p.plane.w));
+      inside =
+          _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+    }
+    int mask = _mm256_movemask_ps(inside);
+    visibleCount += appendVisible(mask, i, visible + visibleCount);
+  }
+  return visibleCount + cullScalar(cull, i, end, visible + visibleCount);
+}
+#endif
+} // unnamed namespace
+
+Frustum Frustum::fromMatrix(const glm::mat4 &viewProjection) {
+  // glm is column-major, so row i is viewProjection[column][i]
+  auto row = [&](int i) {
+    return glm::vec4(viewProjection[0][i], viewProjection[1][i],
+                     viewProjection[2][i], viewProjection[3][i]);
+  };
+
+  // Inside the clip volume -w <= x, y, z <= w
+  Frustum frustum;
+  for (int axis = 0; axis < 3; ++axis) {
+    frustum.planes[axis * 2] = row(3) + row(axis);
+    frustum.planes[axis * 2 + 1] = row(3) - row(axis);
+  }
+  for (glm::vec4 &plane : frustum.planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+  return frustum;
+}
+
+bool Frustum::intersects(const AABB &aabb) const {
+  for (const glm::vec4 &plane : planes) {
+    // Corner furthest along the normal
+    float x = plane.x >= 0.0f ? aabb.max.x : aabb.min.x;
+    float y = plane.y >= 0.0f ? aabb.max.y : aabb.min.y;
+    float z = plane.z >= 0.0f ? aabb.max.z : aabb.min.z;
+    if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t frustumCullBatch(const Frustum &frustum, const AABBBatch &batch,
+                        size_t begin, size_t end, uint32_t *visible) {
+  const std::array<CullPlane, 6> cull = cullPlanes(frustum, batch);
+#ifdef RENDERING_SIMD_X86
+  switch (activeSimdLevel()) {
+  case SimdLevel::AVX2:
+    return cullAVX2(cull, begin, end, visible);
+  case SimdLevel::SSE:
+    return cullSSE(cull, begin, end, visible);
+  case SimdLevel::Scalar:
+    break;
+  }
+#endif
+  return cullScalar(cull, begin, end, visible);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../physics/AABB.h"
+#include "../physics/SimdKernels.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// View volume bounded by six planes (normal, distance) whose normals point
+// inwards: dot(normal, point) + distance >= 0 for points inside.
+struct Frustum {
+  // Left, right, bottom, top, near, far
+  std::array<glm::vec4, 6> planes;
+
+  // Extracts the planes of an OpenGL clip-space transform such as
+  // projection * view (Gribb-Hartmann), normalized
+  static Frustum fromMatrix(const glm::mat4 &viewProjection);
+
+  // False only if the box lies entirely outside one of the planes, so boxes
+  // near the frustum's edges may pass while outside it
+  bool intersects(const AABB &aabb) const;
+};
+
+// Tests the boxes in [begin, end) of the batch against the frustum, like
+// Frustum::intersects, at the active SIMD level. Writes the indices of the
+// boxes that may be visible to visible (which needs room for end - begin
+// entries) and returns how many there are. Ranges that don't overlap may be
+// culled concurrently.
+size_t frustumCullBatch(const Frustum &frustum, const AABBBatch &batch,
+                        size_t begin, size_t end, uint32_t *visible);
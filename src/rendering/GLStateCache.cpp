@@ -0,0 +1,20 @@
+#include "GLStateCache.h"
+
+void GLStateCache::useProgram(GLuint newProgram) {
+  if (newProgram != program) {
+    glUseProgram(newProgram);
+    program = newProgram;
+  }
+}
+
+void GLStateCache::bindVertexArray(GLuint newVertexArray) {
+  if (newVertexArray != vertexArray) {
+    glBindVertexArray(newVertexArray);
+    vertexArray = newVertexArray;
+  }
+}
+
+void GLStateCache::invalidate() {
+  program = UNKNOWN;
+  vertexArray = UNKNOWN;
+}
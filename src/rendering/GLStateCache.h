@@ -0,0 +1,22 @@
+#pragma once
+
+#include "glad/glad.h"
+
+// Remembers the GL state it last set, so binds that wouldn't change anything
+// are skipped. Code that changes the same state without going through the
+// cache must call invalidate() afterwards.
+class GLStateCache {
+public:
+  void useProgram(GLuint program);
+  void bindVertexArray(GLuint vertexArray);
+
+  // Forgets everything, e.g. after shaders are recreated
+  void invalidate();
+
+private:
+  // Binding that hasn't been set through the cache yet
+  static constexpr GLuint UNKNOWN = ~GLuint(0);
+
+  GLuint program = UNKNOWN;
+  GLuint vertexArray = UNKNOWN;
+};
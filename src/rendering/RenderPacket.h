@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../components/Renderable.h"
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Contents of the FrameData uniform block, in std140 layout
+struct FrameData {
+  glm::mat4 projection;
+  glm::mat4 view;
+  glm::vec3 lightDir;
+  // A vec3 is aligned like a vec4 in std140
+  float padding;
+  glm::vec3 lightColor;
+  float ambientStrength;
+};
+static_assert(sizeof(FrameData) == 160, "FrameData must match std140");
+
+// Per-instance vertex attributes, laid out as the 3D vertex shader reads them
+struct InstanceData {
+  glm::mat4 model;
+  glm::vec3 color;
+  // Specular strength and shininess
+  glm::vec2 material;
+};
+
+// Draw items of a frame, split by the frustum test
+struct RenderStats {
+  size_t visible = 0;
+  size_t culled = 0;
+};
+
+// Everything needed to draw one frame, copied out of the components so it
+// can be drawn while the next frame is being extracted
+struct RenderPacket {
+  // Instances [first, first + count) all drawn with mesh in one call
+  struct Batch {
+    MeshHandle mesh;
+    size_t first;
+    size_t count;
+  };
+
+  // False if there was no player to place the camera behind
+  bool hasCamera = false;
+  FrameData frameData;
+  // In render queue order, so each batch's instances are contiguous
+  std::vector<InstanceData> instances;
+  std::vector<Batch> batches;
+  RenderStats stats;
+};
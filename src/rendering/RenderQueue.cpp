@@ -0,0 +1,83 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+const int PASS_SHIFT = 62;
+const int SHADER_SHIFT = 56;
+const int MESH_SHIFT = 40;
+const int MATERIAL_SHIFT = 24;
+const uint64_t SHADER_MASK = 0x3F;
+const uint64_t MESH_MASK = 0xFFFF;
+const uint64_t MATERIAL_MASK = 0xFFFF;
+const uint32_t DEPTH_MASK = 0xFFFFFF;
+
+// Non-negative floats order like their bit patterns; keep the top 24 bits
+uint32_t depthBits(float depth) {
+  depth = std::max(depth, 0.0f);
+  uint32_t bits;
+  std::memcpy(&bits, &depth, sizeof(bits));
+  return bits >> 8;
+}
+} // unnamed namespace
+
+uint64_t RenderQueue::makeKey(Pass pass, uint32_t shader, uint32_t mesh,
+                              uint32_t material, float depth) {
+  uint32_t depthKey = depthBits(depth);
+  if (pass == Pass::Transparent) {
+    depthKey = DEPTH_MASK - depthKey;
+  }
+  return (uint64_t(pass) << PASS_SHIFT) |
+         ((shader & SHADER_MASK) << SHADER_SHIFT) |
+         ((mesh & MESH_MASK) << MESH_SHIFT) |
+         ((material & MATERIAL_MASK) << MATERIAL_SHIFT) | depthKey;
+}
+
+uint64_t RenderQueue::batchOf(uint64_t key) { return key >> MESH_SHIFT; }
+
+void RenderQueue::clear() { entries.clear(); }
+
+void RenderQueue::push(uint64_t key, uint32_t item) {
+  entries.push_back(Entry{key, item});
+}
+
+void RenderQueue::sort() {
+  if (entries.empty()) {
+    return;
+  }
+
+  // Count every byte of every key in one sweep
+  std::array<std::array<size_t, 256>, 8> counts{};
+  for (const Entry &entry : entries) {
+    for (int byte = 0; byte < 8; ++byte) {
+      ++counts[byte][(entry.key >> (byte * 8)) & 0xFF];
+    }
+  }
+
+  scratch.resize(entries.size());
+  for (int byte = 0; byte < 8; ++byte) {
+    std::array<size_t, 256> &count = counts[byte];
+    // All keys share this byte, so the pass wouldn't move anything
+    if (count[(entries.front().key >> (byte * 8)) & 0xFF] == entries.size()) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (size_t &bucket : count) {
+      size_t bucketSize = bucket;
+      bucket = offset;
+      offset += bucketSize;
+    }
+    for (const Entry &entry : entries) {
+      scratch[count[(entry.key >> (byte * 8)) & 0xFF]++] = entry;
+    }
+    entries.swap(scratch);
+  }
+}
+
+size_t RenderQueue::size() const { return entries.size(); }
+
+const RenderQueue::Entry &RenderQueue::operator[](size_t index) const {
+  return entries[index];
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Draws of one frame, ordered by 64-bit sort keys. From the most significant
+// bit down a key holds the render pass (2 bits), shader (6), mesh (16),
+// material (16) and depth (24), so sorting groups the draws that share GPU
+// state and orders each group by depth.
+class RenderQueue {
+public:
+  enum class Pass : uint32_t { Opaque = 0, Transparent = 1 };
+
+  struct Entry {
+    uint64_t key;
+    // Caller's index of the draw
+    uint32_t item;
+  };
+
+  // Packs the fields into a key, keeping only the low bits of each.
+  // depth is the view-space distance: opaque draws sort front to back to
+  // save shading, transparent ones back to front to blend correctly.
+  static uint64_t makeKey(Pass pass, uint32_t shader, uint32_t mesh,
+                          uint32_t material, float depth);
+  // Key without material and depth; draws with the same batch key use the
+  // same pass, shader and mesh
+  static uint64_t batchOf(uint64_t key);
+
+  void clear();
+  void push(uint64_t key, uint32_t item);
+  // Stable LSD radix sort on the keys, a byte per pass. Bytes that every
+  // key shares are skipped, so unused fields cost nothing.
+  void sort();
+
+  size_t size() const;
+  const Entry &operator[](size_t index) const;
+
+private:
+  std::vector<Entry> entries;
+  std::vector<Entry> scratch;
+};
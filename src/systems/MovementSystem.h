@@ -1,16 +1,18 @@
 #pragma once
 
 #include "../components/Acceleration.h"
+#include "../components/Asleep.h"
 #include "../components/OnGround.h"
 #include "../components/PlayerControlled.h"
 #include "../components/Position.h"
 #include "../components/Rotation.h"
 #include "../components/Velocity.h"
 #include "../core/Entity.h"
+#include "../core/System.h"
 #include "../managers/ComponentManager.h"
 #include "../systems/InputSystem.h"
 
-class MovementSystem {
+class MovementSystem : public System {
 private:
   InputSystem *inputSystem;
 
@@ -18,5 +20,5 @@ public:
   MovementSystem(InputSystem *inputSys);
 
   void update(float deltaTime, EntityManager &entityManager,
-              ComponentManager &componentManager);
+              ComponentManager &componentManager) override;
 };
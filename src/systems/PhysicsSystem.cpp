@@ -1,177 +1,605 @@
 #include "PhysicsSystem.h"
+#include "../physics/SimdKernels.h"
+#include "../physics/SweptAABB.h"
 #include <algorithm>
+#include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <utility>
 
 const float GRAVITY = -9.81f * 5.0f;
+// Entities per job when integrating in parallel
+const size_t INTEGRATION_GRAIN_SIZE = 1024;
+// Slack added to the narrowphase's broadphase queries
+const float CANDIDATE_MARGIN = 0.05f;
+// A body slower than these thresholds is at rest
+const float LINEAR_SLEEP_VELOCITY = 0.05f;
+const float ANGULAR_SLEEP_VELOCITY = glm::radians(2.0f);
+// Seconds every body of an island must rest before the island sleeps
+const float TIME_TO_SLEEP = 0.5f;
+// Surfaces a body may slide along within one step before it stops
+const int MAX_SWEEP_ITERATIONS = 4;
+// Contacts whose normal points up at least this much count as ground
+const float GROUND_NORMAL_Y = 0.7f;
+// Orientations closer than this to the identity collide as plain AABBs
+const float ROTATION_EPSILON = 1e-6f;
+
+PhysicsSystem::PhysicsSystem(JobSystem &jobSystem,
+                             std::unique_ptr<Broadphase> _broadphase)
+    : jobSystem(&jobSystem), world(std::move(_broadphase)),
+      usesPairs(world.getBroadphase().tracksPairs()) {
+  // Separated pairs are reported, so cached contacts needn't be rebuilt
+  contactSolver.setKeepsPairs(usesPairs);
+  readsComponents<GravityAffected, Collidable, Scale>();
+  writesComponents<Position, Velocity, Acceleration, Rotation, OnGround,
+                   WorldAABB, SleepState, Asleep>();
+}
 
 void PhysicsSystem::update(float deltaTime, EntityManager &entityManager,
                            ComponentManager &componentManager) {
-  // Update physics for each entity
-  for (EntityID entity = 0; entity < entityManager.entityCount(); ++entity) {
-    const ComponentMask &mask = entityManager.getComponentMask(entity);
-
-    // Update position and velocity
-    if (mask.test(ComponentType<Position>::ID()) &&
-        mask.test(ComponentType<Velocity>::ID()) &&
-        mask.test(ComponentType<Acceleration>::ID())) {
-
-      auto *position = componentManager.getComponent<Position>(entity);
-      auto *velocity = componentManager.getComponent<Velocity>(entity);
-      auto *acceleration = componentManager.getComponent<Acceleration>(entity);
-
-      // Apply gravity to entities with GravityAffected component
-      if (mask.test(ComponentType<GravityAffected>::ID())) {
-        acceleration->ay += GRAVITY;
-      }
+  // Update position and velocity of the bodies that are awake, in place
+  const size_t gravityID = ComponentType<GravityAffected>::ID();
+  componentManager.view<Position, Velocity, Acceleration>(entityManager)
+      .exclude<Asleep>()
+      .parallelEach(*jobSystem, INTEGRATION_GRAIN_SIZE,
+                    [&](EntityID entity, Position &position,
+                        Velocity &velocity, Acceleration &acceleration) {
+                      // Apply gravity to entities with GravityAffected
+                      float gravity =
+                          entityManager.getComponentMask(entity).test(gravityID)
+                              ? GRAVITY
+                              : 0.0f;
 
-      // Update velocity based on acceleration
-      velocity->dx += acceleration->ax * deltaTime;
-      velocity->dy += acceleration->ay * deltaTime;
-      velocity->dz += acceleration->az * deltaTime;
+                      velocity.dx += acceleration.ax * deltaTime;
+                      velocity.dy += (acceleration.ay + gravity) * deltaTime;
+                      velocity.dz += acceleration.az * deltaTime;
+                      position.x += velocity.dx * deltaTime;
+                      position.y += velocity.dy * deltaTime;
+                      position.z += velocity.dz * deltaTime;
 
-      // Update position based on velocity
-      position->x += velocity->dx * deltaTime;
-      position->y += velocity->dy * deltaTime;
-      position->z += velocity->dz * deltaTime;
+                      // Reset acceleration for the next frame
+                      acceleration = Acceleration();
+                    });
 
-      // Reset acceleration for the next frame
-      acceleration->ax = 0.0f;
-      acceleration->ay = 0.0f;
-      acceleration->az = 0.0f;
-    }
+  // Update rotation for entities with Rotation component
+  componentManager.view<Rotation>(entityManager)
+      .exclude<Asleep>()
+      .parallelEach(
+          *jobSystem, INTEGRATION_GRAIN_SIZE,
+          [&](EntityID, Rotation &rotation) {
+            // Update angular velocity based on angular acceleration
+            rotation.angularVelocity +=
+                rotation.angularAcceleration * deltaTime;
 
-    // Update rotation for entities with Rotation component
-    if (mask.test(ComponentType<Rotation>::ID())) {
-      auto *rotation = componentManager.getComponent<Rotation>(entity);
+            // Convert angular velocity to a quaternion
+            glm::quat deltaRotation =
+                glm::quat(glm::vec3(rotation.angularVelocity * deltaTime));
 
-      // Update angular velocity based on angular acceleration
-      rotation->angularVelocity += rotation->angularAcceleration * deltaTime;
+            // Update the quaternion in the rotation component
+            rotation.quaternion = deltaRotation * rotation.quaternion;
 
-      // Convert angular velocity to a quaternion
-      glm::quat deltaRotation =
-          glm::quat(glm::vec3(rotation->angularVelocity * deltaTime));
+            // Normalize the quaternion to prevent numerical drift
+            rotation.quaternion = glm::normalize(rotation.quaternion);
 
-      // Update the quaternion in the rotation component
-      rotation->quaternion = deltaRotation * rotation->quaternion;
+            // Reset angular acceleration
+            rotation.angularAcceleration = glm::vec3(0.0f);
+          });
 
-      // Normalize the quaternion to prevent numerical drift
-      rotation->quaternion = glm::normalize(rotation->quaternion);
+  // Refresh the cached bounds of moving bodies; static ones never change
+  componentManager.view<GravityAffected, Position, WorldAABB>(entityManager)
+      .exclude<Asleep>()
+      .parallelEach(*jobSystem, INTEGRATION_GRAIN_SIZE,
+                    [&](EntityID entity, GravityAffected &, Position &,
+                        WorldAABB &worldAABB) {
+                      worldAABB.bounds =
+                          colliderBox(entity, componentManager).bounds();
+                    });
 
-      // Reset angular acceleration
-      rotation->angularAcceleration = glm::vec3(0.0f);
-    }
-  }
+  updateWorld(deltaTime, entityManager, componentManager);
+
+  findContacts(deltaTime, entityManager, componentManager);
+  resolveContacts(deltaTime, entityManager, componentManager);
+
+  updateSleep(deltaTime, entityManager, componentManager);
+}
 
-  // Handle collisions and grounded state
-  for (EntityID entity = 0; entity < entityManager.entityCount(); ++entity) {
-    const ComponentMask &mask = entityManager.getComponentMask(entity);
+const PhysicsWorld &PhysicsSystem::getWorld() const { return world; }
 
-    if (mask.test(ComponentType<Position>::ID()) &&
-        mask.test(ComponentType<Velocity>::ID()) &&
-        mask.test(ComponentType<Collidable>::ID())) {
+void PhysicsSystem::findContacts(float deltaTime, EntityManager &entityManager,
+                                 ComponentManager &componentManager) {
+  ComponentMask bodyMask;
+  bodyMask.set(ComponentType<GravityAffected>::ID());
+  bodyMask.set(ComponentType<Collidable>::ID());
+  bodyMask.set(ComponentType<Position>::ID());
+  bodyMask.set(ComponentType<Velocity>::ID());
 
-      auto *position = componentManager.getComponent<Position>(entity);
-      auto *velocity = componentManager.getComponent<Velocity>(entity);
+  // Only last step's bodies have an index to reset
+  for (const DynamicBody &body : dynamicBodies) {
+    solverBodyIndices[entityIndex(body.entity)] = Contact::NO_BODY;
+  }
+  dynamicBodies.clear();
+  solverBodies.clear();
+  contacts.clear();
+  bodyContacts.clear();
 
-      // Only check collisions for entities affected by gravity
-      if (mask.test(ComponentType<GravityAffected>::ID())) {
+  // Only awake entities affected by gravity are checked, and only against
+  // the candidates the broadphase returns
+  componentManager
+      .view<GravityAffected, Collidable, Position, Velocity>(entityManager)
+      .exclude<Asleep>()
+      .each([&](EntityID entity, GravityAffected &, Collidable &,
+                Position &position, Velocity &velocity) {
         bool isGrounded = false;
+        AABB bounds = colliderBounds(entity, componentManager);
+        // Resting bodies don't disturb sleeping ones they lie against
+        auto *sleepState = componentManager.getComponent<SleepState>(entity);
+        bool isMoving = !sleepState || sleepState->restTime <= 0.0f;
 
-        // Check collision with other collidable entities
-        for (EntityID otherEntity = 0;
-             otherEntity < entityManager.entityCount(); ++otherEntity) {
-          if (otherEntity == entity) {
-            continue;
-          }
+        // Query the whole box swept this step. The proxies of bodies
+        // resolved earlier in this loop are a step behind, so add some slack
+        // and test the cached bounds, which are up to date. A broadphase
+        // tracking pairs already holds them: every proxy covers its motion.
+        glm::vec3 displacement =
+            glm::vec3(velocity.dx, velocity.dy, velocity.dz) * deltaTime;
+        AABB start(bounds.min - displacement, bounds.max - displacement);
+        candidates.clear();
+        if (usesPairs) {
+          world.getBroadphase().pairsOf(entity, candidates);
+        } else {
+          world.getBroadphase().query(candidateArea(bounds, displacement),
+                                      candidates);
+        }
 
+        candidateBounds.clear();
+        candidateMoves.clear();
+        candidateRotated.clear();
+        for (EntityID otherEntity : candidates) {
+          candidateBounds.push_back(
+              colliderBounds(otherEntity, componentManager));
           const ComponentMask &otherMask =
               entityManager.getComponentMask(otherEntity);
+          candidateMoves.push_back(
+              (otherMask & bodyMask) == bodyMask &&
+              !otherMask.test(ComponentType<Asleep>::ID()));
+          candidateRotated.push_back(isRotated(otherEntity, componentManager));
+        }
 
-          if (otherMask.test(ComponentType<Position>::ID()) &&
-              otherMask.test(ComponentType<Collidable>::ID())) {
-
-            auto *otherPosition =
-                componentManager.getComponent<Position>(otherEntity);
-
-            // Get scales for both entities
-            float entityHalfSizeX = 0.5f;
-            float entityHalfSizeY = 0.5f;
-            float entityHalfSizeZ = 0.5f;
-            if (mask.test(ComponentType<Scale>::ID())) {
-              auto *scale = componentManager.getComponent<Scale>(entity);
-              entityHalfSizeX *= scale->scale.x;
-              entityHalfSizeY *= scale->scale.y;
-              entityHalfSizeZ *= scale->scale.z;
-            }
+        // Replay the step's motion against the static candidates so fast
+        // bodies stop at the first surface instead of tunnelling through it.
+        // Rotated colliders are only resolved discretely, their bounds would
+        // stop bodies short of the actual surface.
+        AABB swept = sweepBody(start, displacement, velocity, isGrounded);
+        glm::vec3 correction = swept.min - bounds.min;
+        position.x += correction.x;
+        position.y += correction.y;
+        position.z += correction.z;
+        bounds = swept;
 
-            float otherHalfSizeX = 0.5f;
-            float otherHalfSizeY = 0.5f;
-            float otherHalfSizeZ = 0.5f;
-            if (otherMask.test(ComponentType<Scale>::ID())) {
-              auto *otherScale =
-                  componentManager.getComponent<Scale>(otherEntity);
-              otherHalfSizeX *= otherScale->scale.x;
-              otherHalfSizeY *= otherScale->scale.y;
-              otherHalfSizeZ *= otherScale->scale.z;
-            }
+        if (auto *worldAABB =
+                componentManager.getComponent<WorldAABB>(entity)) {
+          worldAABB->bounds = bounds;
+        }
 
-            // Check for collision along each axis (X, Y, Z)
-            bool collisionX = position->x + entityHalfSizeX >=
-                                  otherPosition->x - otherHalfSizeX &&
-                              otherPosition->x + otherHalfSizeX >=
-                                  position->x - entityHalfSizeX;
-            bool collisionY = position->y + entityHalfSizeY >=
-                                  otherPosition->y - otherHalfSizeY &&
-                              otherPosition->y + otherHalfSizeY >=
-                                  position->y - entityHalfSizeY;
-            bool collisionZ = position->z + entityHalfSizeZ >=
-                                  otherPosition->z - otherHalfSizeZ &&
-                              otherPosition->z + otherHalfSizeZ >=
-                                  position->z - entityHalfSizeZ;
-
-            if (collisionX && collisionY && collisionZ) {
-              // Collision detected
-
-              // Determine penetration depth in Y-axis
-              float penetrationY =
-                  std::min(position->y + entityHalfSizeY -
-                               (otherPosition->y - otherHalfSizeY),
-                           otherPosition->y + otherHalfSizeY -
-                               (position->y - entityHalfSizeY));
-
-              // Correct the entity's position to resolve collision
-              if (penetrationY > 0.0f) {
-                if (velocity->dy < 0.0f) {
-                  // Landing on top of the other entity
-                  position->y += penetrationY;
-                  velocity->dy = 0.0f;
-                  isGrounded = true; // Entity is grounded
-                } else if (velocity->dy > 0.0f) {
-                  // Hitting the underside of an object
-                  position->y -= penetrationY;
-                  velocity->dy = 0.0f;
-                }
-              }
+        bool isBodyRotated = isRotated(entity, componentManager);
+        uint32_t bodyIndex = static_cast<uint32_t>(solverBodies.size());
+        EntityIndex index = entityIndex(entity);
+        if (index >= solverBodyIndices.size()) {
+          solverBodyIndices.resize(index + 1, Contact::NO_BODY);
+        }
+        solverBodyIndices[index] = bodyIndex;
+        dynamicBodies.push_back({entity, &position, &velocity, isGrounded});
+        solverBodies.push_back(
+            {glm::vec3(velocity.dx, velocity.dy, velocity.dz), 1.0f});
+
+        candidateHits.resize(candidates.size());
+        size_t hitCount =
+            overlapBatch(bounds, candidateBounds, candidateHits.data());
+
+        for (size_t hit = 0; hit < hitCount; ++hit) {
+          uint32_t index = candidateHits[hit];
+          EntityID otherEntity = candidates[index];
+          if (otherEntity == entity) {
+            continue;
+          }
+
+          // Static colliders and sleeping bodies don't move. A pair of awake
+          // bodies is handled by the one resolved second, once both have
+          // their final bounds.
+          uint32_t otherIndex = Contact::NO_BODY;
+          if (candidateMoves[index]) {
+            otherIndex = solverBody(otherEntity);
+            if (otherIndex == Contact::NO_BODY) {
+              continue;
             }
           }
-        }
 
-        // Update the OnGround component based on the isGrounded flag
-        if (isGrounded) {
-          // Add the OnGround component if not already present
-          if (!mask.test(ComponentType<OnGround>::ID())) {
-            componentManager.addComponent(entity, OnGround(), entityManager);
+          // The bounds overlap; rotated boxes still need the oriented test
+          Contact contact;
+          bool isTouching =
+              isBodyRotated || candidateRotated[index]
+                  ? intersectOBB(colliderBox(entity, componentManager),
+                                 colliderBox(otherEntity, componentManager),
+                                 contact.normal, contact.depth)
+                  : computeContact(bounds, candidateBounds.at(index),
+                                   contact.normal, contact.depth);
+          if (!isTouching) {
+            continue;
           }
-        } else {
-          // Remove the OnGround component if present
-          if (mask.test(ComponentType<OnGround>::ID())) {
-            componentManager.removeComponent<OnGround>(entity);
-            entityManager.getComponentMask(entity).reset(
-                ComponentType<OnGround>::ID());
+          contact.entityA = entity;
+          contact.entityB = otherEntity;
+          contact.bodyA = bodyIndex;
+          contact.bodyB = otherIndex;
+          contacts.push_back(contact);
+
+          // Touching another body joins its island, or wakes it up
+          const ComponentMask &otherMask =
+              entityManager.getComponentMask(otherEntity);
+          if (otherMask.test(ComponentType<GravityAffected>::ID())) {
+            if (otherMask.test(ComponentType<Asleep>::ID())) {
+              if (isMoving) {
+                wakeUp(otherEntity, entityManager, componentManager);
+              }
+            } else {
+              bodyContacts.emplace_back(entity, otherEntity);
+            }
           }
         }
+      });
+}
+
+void PhysicsSystem::resolveContacts(float deltaTime,
+                                    EntityManager &entityManager,
+                                    ComponentManager &componentManager) {
+  contactSolver.solve(solverBodies, contacts, deltaTime);
+
+  // A contact pushing a body up is ground it stands on
+  for (const Contact &contact : contacts) {
+    if (contact.normal.y > GROUND_NORMAL_Y) {
+      dynamicBodies[contact.bodyA].isGrounded = true;
+    } else if (contact.bodyB != Contact::NO_BODY &&
+               -contact.normal.y > GROUND_NORMAL_Y) {
+      dynamicBodies[contact.bodyB].isGrounded = true;
+    }
+  }
+
+  for (size_t i = 0; i < dynamicBodies.size(); ++i) {
+    DynamicBody &body = dynamicBodies[i];
+    const SolverBody &solved = solverBodies[i];
+    body.velocity->dx = solved.velocity.x;
+    body.velocity->dy = solved.velocity.y;
+    body.velocity->dz = solved.velocity.z;
+    body.position->x += solved.correction.x;
+    body.position->y += solved.correction.y;
+    body.position->z += solved.correction.z;
+
+    // Leave the world where the bodies ended up, for queries between steps.
+    // Tracked pairs keep the slack, so resting contacts don't drop out.
+    OBB box = colliderBox(body.entity, componentManager);
+    if (auto *worldAABB =
+            componentManager.getComponent<WorldAABB>(body.entity)) {
+      worldAABB->bounds = box.bounds();
+    }
+    if (usesPairs) {
+      world.moveCollider(body.entity, box,
+                         box.bounds().fattened(CANDIDATE_MARGIN));
+    } else {
+      world.moveCollider(body.entity, box);
+    }
+
+    // Update the OnGround component based on the isGrounded flag
+    const ComponentMask &mask = entityManager.getComponentMask(body.entity);
+    if (body.isGrounded) {
+      // Add the OnGround component if not already present
+      if (!mask.test(ComponentType<OnGround>::ID())) {
+        commands.addComponent(body.entity, OnGround());
+      }
+    } else {
+      // Remove the OnGround component if present
+      if (mask.test(ComponentType<OnGround>::ID())) {
+        commands.removeComponent<OnGround>(body.entity);
+      }
+    }
+  }
+}
+
+AABB PhysicsSystem::sweepBody(AABB bounds, glm::vec3 displacement,
+                              Velocity &velocity, bool &isGrounded) const {
+  for (int iteration = 0; iteration < MAX_SWEEP_ITERATIONS; ++iteration) {
+    SweepHit earliest{1.0f, glm::vec3(0.0f)};
+    bool hasHit = false;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      SweepHit hit;
+      if (!candidateMoves[i] && !candidateRotated[i] &&
+          sweepAABB(bounds, displacement, candidateBounds.at(i), hit) &&
+          (!hasHit || hit.time < earliest.time)) {
+        earliest = hit;
+        hasHit = true;
       }
     }
+
+    if (!hasHit) {
+      return AABB(bounds.min + displacement, bounds.max + displacement);
+    }
+
+    // Advance to the contact, then slide along the surface with what's left
+    glm::vec3 travelled = displacement * earliest.time;
+    bounds = AABB(bounds.min + travelled, bounds.max + travelled);
+    displacement -= travelled;
+
+    const glm::vec3 &normal = earliest.normal;
+    displacement -= normal * std::min(glm::dot(displacement, normal), 0.0f);
+    glm::vec3 linear(velocity.dx, velocity.dy, velocity.dz);
+    linear -= normal * std::min(glm::dot(linear, normal), 0.0f);
+    velocity.dx = linear.x;
+    velocity.dy = linear.y;
+    velocity.dz = linear.z;
+
+    if (normal.y > 0.0f) {
+      isGrounded = true;
+    }
+  }
+
+  // Out of iterations: stay at the last contact
+  return bounds;
+}
+
+void PhysicsSystem::updateSleep(float deltaTime, EntityManager &entityManager,
+                                ComponentManager &componentManager) {
+  // Advance the rest timer of every awake body that can sleep
+  for (EntityID entity : sleepBodies) {
+    sleepBodyIndices[entityIndex(entity)] = NO_SLEEP_BODY;
   }
+  sleepBodies.clear();
+  componentManager.view<SleepState, Velocity>(entityManager)
+      .exclude<Asleep>()
+      .each([&](EntityID entity, SleepState &sleepState, Velocity &velocity) {
+        // Woken from outside (e.g. by input): wake the rest of its island
+        if (sleepState.island != INVALID_ENTITY) {
+          wakeUp(entity, entityManager, componentManager);
+        }
+
+        glm::vec3 linear(velocity.dx, velocity.dy, velocity.dz);
+        bool isResting = glm::dot(linear, linear) <
+                         LINEAR_SLEEP_VELOCITY * LINEAR_SLEEP_VELOCITY;
+        if (auto *rotation = componentManager.getComponent<Rotation>(entity)) {
+          isResting = isResting && glm::length(rotation->angularVelocity) <
+                                       ANGULAR_SLEEP_VELOCITY;
+        }
+        sleepState.restTime =
+            isResting ? sleepState.restTime + deltaTime : 0.0f;
+
+        EntityIndex index = entityIndex(entity);
+        if (index >= sleepBodyIndices.size()) {
+          sleepBodyIndices.resize(index + 1, NO_SLEEP_BODY);
+        }
+        sleepBodyIndices[index] = sleepBodies.size();
+        sleepBodies.push_back(entity);
+      });
+
+  // Bodies in contact form an island, which only sleeps as a whole
+  islands.reset(sleepBodies.size());
+  for (const auto &[a, b] : bodyContacts) {
+    size_t first = sleepBody(a);
+    size_t second = sleepBody(b);
+    if (first != NO_SLEEP_BODY && second != NO_SLEEP_BODY) {
+      islands.unite(first, second);
+    }
+  }
+
+  std::vector<bool> islandAwake(sleepBodies.size(), false);
+  for (size_t i = 0; i < sleepBodies.size(); ++i) {
+    EntityID entity = sleepBodies[i];
+    if (componentManager.getComponent<SleepState>(entity)->restTime <
+        TIME_TO_SLEEP) {
+      islandAwake[islands.find(i)] = true;
+    }
+  }
+
+  for (size_t i = 0; i < sleepBodies.size(); ++i) {
+    size_t root = islands.find(i);
+    if (islandAwake[root]) {
+      continue;
+    }
+
+    EntityID entity = sleepBodies[i];
+    EntityID island = sleepBodies[root];
+    componentManager.getComponent<SleepState>(entity)->island = island;
+    EntityIndex index = entityIndex(island);
+    if (index >= sleepingIslands.size()) {
+      sleepingIslands.resize(index + 1);
+    }
+    // The slot may still list an island whose ID has since been destroyed
+    SleepingIsland &sleeping = sleepingIslands[index];
+    if (sleeping.island != island) {
+      sleeping.island = island;
+      sleeping.members.clear();
+    }
+    sleeping.members.push_back(entity);
+
+    // Come to a full stop so the body wakes up at rest
+    *componentManager.getComponent<Velocity>(entity) = Velocity();
+    if (auto *rotation = componentManager.getComponent<Rotation>(entity)) {
+      rotation->angularVelocity = glm::vec3(0.0f);
+    }
+    commands.addComponent(entity, Asleep());
+  }
+}
+
+void PhysicsSystem::wakeUp(EntityID entity, EntityManager &entityManager,
+                           ComponentManager &componentManager) {
+  auto *sleepState = componentManager.getComponent<SleepState>(entity);
+  if (!sleepState || sleepState->island == INVALID_ENTITY) {
+    return;
+  }
+
+  EntityID islandID = sleepState->island;
+  EntityIndex index = entityIndex(islandID);
+  if (index >= sleepingIslands.size() ||
+      sleepingIslands[index].island != islandID) {
+    // The island's slot went to another island: wake just this body
+    sleepState->island = INVALID_ENTITY;
+    sleepState->restTime = 0.0f;
+    commands.removeComponent<Asleep>(entity);
+    return;
+  }
+  std::vector<EntityID> members = std::move(sleepingIslands[index].members);
+  sleepingIslands[index] = SleepingIsland();
+
+  std::vector<EntityID> neighbours;
+  for (EntityID member : members) {
+    // Skip members that were destroyed or have woken up on their own since
+    auto *memberState = componentManager.getComponent<SleepState>(member);
+    if (!memberState || memberState->island != islandID) {
+      continue;
+    }
+    memberState->island = INVALID_ENTITY;
+    memberState->restTime = 0.0f;
+    commands.removeComponent<Asleep>(member);
+
+    // Sleeping bodies that came to rest against this one must not be left
+    // hanging once it moves
+    if (entityManager.getComponentMask(member).test(
+            ComponentType<Collidable>::ID())) {
+      world.getBroadphase().query(
+          colliderBounds(member, componentManager).fattened(CANDIDATE_MARGIN),
+          neighbours);
+    }
+  }
+
+  // Only bodies that can sleep have an island to wake; static colliders
+  // are skipped
+  ComponentMask sleeperMask;
+  sleeperMask.set(ComponentType<SleepState>::ID());
+  sleeperMask.set(ComponentType<Asleep>::ID());
+  for (EntityID neighbour : neighbours) {
+    if (entityManager.isAlive(neighbour) &&
+        (entityManager.getComponentMask(neighbour) & sleeperMask) ==
+            sleeperMask) {
+      wakeUp(neighbour, entityManager, componentManager);
+    }
+  }
+}
+
+void PhysicsSystem::updateWorld(float deltaTime, EntityManager &entityManager,
+                                ComponentManager &componentManager) {
+  ComponentMask collidableMask;
+  collidableMask.set(ComponentType<Collidable>::ID());
+  collidableMask.set(ComponentType<Position>::ID());
+
+  // Drop colliders of destroyed entities and of entities that lost a component
+  for (size_t i = 0; i < colliderEntities.size();) {
+    EntityID entity = colliderEntities[i];
+    if (entityManager.isAlive(entity) &&
+        (entityManager.getComponentMask(entity) & collidableMask) ==
+            collidableMask) {
+      ++i;
+      continue;
+    }
+    world.removeCollider(entity);
+    colliderEntities[i] = colliderEntities.back();
+    colliderEntities.pop_back();
+  }
+
+  // Static colliders are inserted once; dynamic ones follow their body
+  componentManager.view<Collidable, Position>(entityManager)
+      .each([&](EntityID entity, Collidable &, Position &) {
+        const ComponentMask &mask = entityManager.getComponentMask(entity);
+        bool isStatic = !mask.test(ComponentType<GravityAffected>::ID());
+        bool isTracked = world.hasCollider(entity);
+        // Static colliders and sleeping bodies don't move
+        if (isTracked &&
+            (isStatic || mask.test(ComponentType<Asleep>::ID()))) {
+          return;
+        }
+
+        OBB box = colliderBox(entity, componentManager);
+        if (!componentManager.getComponent<WorldAABB>(entity)) {
+          // New collidable: cache its bounds from the next step on
+          commands.addComponent(entity, WorldAABB(box.bounds()));
+        }
+
+        if (!isTracked) {
+          world.addCollider(entity, box, isStatic);
+          colliderEntities.push_back(entity);
+        } else if (!usesPairs) {
+          world.moveCollider(entity, box);
+        }
+
+        // Bodies take their candidates from their proxy's pairs, so it has
+        // to cover where they start and end the step
+        if (usesPairs && !isStatic) {
+          glm::vec3 displacement(0.0f);
+          if (auto *velocity =
+                  componentManager.getComponent<Velocity>(entity)) {
+            displacement =
+                glm::vec3(velocity->dx, velocity->dy, velocity->dz) * deltaTime;
+          }
+          world.moveCollider(entity, box,
+                             candidateArea(box.bounds(), displacement));
+        }
+      });
+
+  // Pairs that separated can't be in contact any more
+  removedPairs.clear();
+  world.getBroadphase().takeRemovedPairs(removedPairs);
+  for (const auto &[a, b] : removedPairs) {
+    contactSolver.forgetPair(a, b);
+  }
+}
+
+uint32_t PhysicsSystem::solverBody(EntityID entity) const {
+  EntityIndex index = entityIndex(entity);
+  if (index >= solverBodyIndices.size()) {
+    return Contact::NO_BODY;
+  }
+  uint32_t body = solverBodyIndices[index];
+  return body != Contact::NO_BODY && dynamicBodies[body].entity == entity
+             ? body
+             : Contact::NO_BODY;
+}
+
+size_t PhysicsSystem::sleepBody(EntityID entity) const {
+  EntityIndex index = entityIndex(entity);
+  if (index >= sleepBodyIndices.size()) {
+    return NO_SLEEP_BODY;
+  }
+  size_t body = sleepBodyIndices[index];
+  return body != NO_SLEEP_BODY && sleepBodies[body] == entity ? body
+                                                              : NO_SLEEP_BODY;
+}
+
+AABB PhysicsSystem::candidateArea(const AABB &bounds,
+                                  const glm::vec3 &displacement) {
+  AABB start(bounds.min - displacement, bounds.max - displacement);
+  return AABB::merge(start, bounds).fattened(CANDIDATE_MARGIN);
+}
+
+AABB PhysicsSystem::colliderBounds(EntityID entity,
+                                   ComponentManager &componentManager) {
+  if (auto *worldAABB = componentManager.getComponent<WorldAABB>(entity)) {
+    return worldAABB->bounds;
+  }
+  return colliderBox(entity, componentManager).bounds();
+}
+
+OBB PhysicsSystem::colliderBox(EntityID entity,
+                               ComponentManager &componentManager) {
+  const Position &position = *componentManager.getComponent<Position>(entity);
+  glm::vec3 halfSize(0.5f);
+  if (auto *scale = componentManager.getComponent<Scale>(entity)) {
+    halfSize *= scale->scale;
+  }
+  glm::quat orientation(1.0f, 0.0f, 0.0f, 0.0f);
+  if (auto *rotation = componentManager.getComponent<Rotation>(entity)) {
+    orientation = rotation->quaternion;
+  }
+  return OBB(glm::vec3(position.x, position.y, position.z), halfSize,
+             orientation);
+}
+
+bool PhysicsSystem::isRotated(EntityID entity,
+                              ComponentManager &componentManager) {
+  auto *rotation = componentManager.getComponent<Rotation>(entity);
+  return rotation &&
+         std::abs(rotation->quaternion.w) < 1.0f - ROTATION_EPSILON;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../components/Acceleration.h"
+#include "../components/Asleep.h"
 #include "../components/Collidable.h"
 #include "../components/GravityAffected.h"
 #include "../components/OnGround.h"
@@ -8,15 +9,132 @@
 #include "../components/Position.h"
 #include "../components/Rotation.h"
 #include "../components/Scale.h"
+#include "../components/SleepState.h"
 #include "../components/Velocity.h"
+#include "../components/WorldAABB.h"
 #include "../core/Entity.h"
+#include "../core/JobSystem.h"
+#include "../core/System.h"
 #include "../managers/ComponentManager.h"
+#include "../physics/AABB.h"
+#include "../physics/Broadphase.h"
+#include "../physics/ContactSolver.h"
+#include "../physics/OBB.h"
+#include "../physics/PhysicsWorld.h"
+#include "../physics/SimdKernels.h"
+#include "../physics/UnionFind.h"
 #include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <memory>
+#include <utility>
+#include <vector>
 
-class PhysicsSystem {
+class PhysicsSystem : public System {
 public:
+  // Uses a DynamicTreeBroadphase unless another broadphase is given
+  PhysicsSystem(JobSystem &jobSystem,
+                std::unique_ptr<Broadphase> _broadphase = nullptr);
+
   void update(float deltaTime, EntityManager &entityManager,
+              ComponentManager &componentManager) override;
+
+  // Collision scene for ray, shape and overlap queries. Up to date between
+  // steps; must not be queried while the system runs.
+  const PhysicsWorld &getWorld() const;
+
+private:
+  JobSystem *jobSystem;
+  PhysicsWorld world;
+  // The broadphase keeps each body's candidates as pairs, so the proxies of
+  // awake bodies cover their motion over the step
+  bool usesPairs;
+  // Entities that currently own a collider in the world
+  std::vector<EntityID> colliderEntities;
+  // Scratch buffers reused by every narrowphase query
+  std::vector<EntityID> candidates;
+  AABBBatch candidateBounds;
+  std::vector<uint32_t> candidateHits;
+  // Candidates that are awake bodies; the contact solver handles those
+  std::vector<bool> candidateMoves;
+  std::vector<bool> candidateRotated;
+
+  // Awake dynamic bodies resolved this step, in solver body order
+  struct DynamicBody {
+    EntityID entity;
+    Position *position;
+    Velocity *velocity;
+    bool isGrounded;
+  };
+  std::vector<DynamicBody> dynamicBodies;
+  std::vector<SolverBody> solverBodies;
+  // Solver body of each entity resolved this step, by entity index
+  // (Contact::NO_BODY if none)
+  std::vector<uint32_t> solverBodyIndices;
+  std::vector<Contact> contacts;
+  ContactSolver contactSolver;
+  // Pairs the broadphase saw separate since the last step
+  std::vector<std::pair<EntityID, EntityID>> removedPairs;
+
+  // Pairs of awake dynamic bodies that touched this step
+  std::vector<std::pair<EntityID, EntityID>> bodyContacts;
+  // Awake bodies with a SleepState, and their index in islands by entity
+  // index (NO_SLEEP_BODY if none)
+  static constexpr size_t NO_SLEEP_BODY = ~size_t(0);
+  std::vector<EntityID> sleepBodies;
+  std::vector<size_t> sleepBodyIndices;
+  UnionFind islands;
+
+  // Members of a sleeping island, whose ID is the entity it is stored under
+  struct SleepingIsland {
+    EntityID island = INVALID_ENTITY;
+    std::vector<EntityID> members;
+  };
+  // Sleeping islands by the entity index of their ID
+  std::vector<SleepingIsland> sleepingIslands;
+
+  // Adds colliders for new collidables, moves the dynamic ones and drops
+  // the colliders of entities that are gone or no longer collidable
+  void updateWorld(float deltaTime, EntityManager &entityManager,
+                   ComponentManager &componentManager);
+  // Sweeps every awake body against its candidates and collects the contacts
+  // it ends up in
+  void findContacts(float deltaTime, EntityManager &entityManager,
+                    ComponentManager &componentManager);
+  // Runs the contact solver and writes velocities, positions and grounded
+  // state back to the bodies
+  void resolveContacts(float deltaTime, EntityManager &entityManager,
+                       ComponentManager &componentManager);
+
+  // Moves bounds by displacement against the current candidates that don't
+  // move and aren't rotated, stopping at each surface hit and sliding along
+  // it. Removes the velocity into the surfaces hit and returns the final
+  // bounds.
+  AABB sweepBody(AABB bounds, glm::vec3 displacement, Velocity &velocity,
+                 bool &isGrounded) const;
+  // Advances rest timers and puts islands whose bodies all rest to sleep
+  void updateSleep(float deltaTime, EntityManager &entityManager,
+                   ComponentManager &componentManager);
+  // Wakes the whole island the entity fell asleep with, and the sleeping
+  // bodies touching it
+  void wakeUp(EntityID entity, EntityManager &entityManager,
               ComponentManager &componentManager);
+
+  // Index of the entity's solver body this step, or Contact::NO_BODY
+  uint32_t solverBody(EntityID entity) const;
+  // Index of the entity in sleepBodies this step, or NO_SLEEP_BODY
+  size_t sleepBody(EntityID entity) const;
+  // Box a body's candidates must overlap: its bounds before and after the
+  // step's displacement, with some slack
+  static AABB candidateArea(const AABB &bounds, const glm::vec3 &displacement);
+  // Cached WorldAABB of a collider, computed on the spot for collidables
+  // that haven't been given one yet
+  static AABB colliderBounds(EntityID entity,
+                             ComponentManager &componentManager);
+  // Collision box of a collider: a unit cube at its position, stretched by
+  // its scale and turned by its rotation
+  static OBB colliderBox(EntityID entity, ComponentManager &componentManager);
+  // Whether the collider is turned away from the world axes, so its
+  // WorldAABB is only a bound and contacts need the oriented test
+  static bool isRotated(EntityID entity, ComponentManager &componentManager);
 };
@@ -0,0 +1,226 @@
+#include "./RenderExtractionSystem.h"
+#include <functional>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <iostream>
+
+// Draw items per job when building model matrices and culling in parallel
+const size_t TRANSFORM_GRAIN_SIZE = 512;
+// Size of the camera when it collides with the scene
+const float CAMERA_RADIUS = 0.3f;
+const float AMBIENT_STRENGTH = 0.5f;
+// Shader field of the render queue keys for the 3D shader
+const uint32_t SHADER_3D = 0;
+
+namespace {
+// Render queue key field that clusters equal materials. Materials are
+// instance data, so this only orders the draws within a batch.
+uint32_t materialKey(const Material &material) {
+  uint64_t hash = 0;
+  for (float value : {material.diffuseColor.r, material.diffuseColor.g,
+                      material.diffuseColor.b, material.specularStrength,
+                      material.shininess}) {
+    hash = hash * 31 + std::hash<float>()(value);
+  }
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+} // unnamed namespace
+
+RenderExtractionSystem::RenderExtractionSystem(JobSystem &jobs,
+                                               const MeshRegistry &meshes,
+                                               const PhysicsWorld *world)
+    : jobSystem(&jobs), meshRegistry(&meshes), physicsWorld(world),
+      viewportWidth(WINDOW_WIDTH), viewportHeight(WINDOW_HEIGHT) {
+  readsComponents<PlayerControlled, Position, Rotation, Scale, Renderable3D,
+                  Material>();
+}
+
+void RenderExtractionSystem::setViewport(int width, int height) {
+  viewportWidth = width;
+  viewportHeight = height;
+}
+
+const RenderPacket &RenderExtractionSystem::latestPacket() const {
+  return packets[latest];
+}
+
+void RenderExtractionSystem::sync() { latest = 1 - latest; }
+
+void RenderExtractionSystem::update(float, EntityManager &entityManager,
+                                    ComponentManager &componentManager) {
+  RenderPacket &packet = packets[1 - latest];
+  packet.hasCamera = false;
+  packet.instances.clear();
+  packet.batches.clear();
+  packet.stats = RenderStats();
+
+  // Find the player entity
+  EntityID player = INVALID_ENTITY;
+  Position *playerPosition = nullptr;
+  Rotation *playerRotation = nullptr;
+
+  componentManager.view<PlayerControlled, Position, Rotation>(entityManager)
+      .each([&](EntityID entity, PlayerControlled &, Position &position,
+                Rotation &rotation) {
+        player = entity;
+        playerPosition = &position;
+        playerRotation = &rotation;
+      });
+
+  if (playerPosition == nullptr || playerRotation == nullptr) {
+    std::cerr << "Error: No player entity found." << std::endl;
+    return;
+  }
+
+  // Set up the camera's view matrix
+  glm::vec3 cameraOffset(0.0f, 5.0f, 15.0f);
+
+  glm::vec3 forward = playerRotation->quaternion * glm::vec3(0.0f, 0.0f, -1.0f);
+  forward.y = 0.0f;
+  forward = glm::normalize(forward);
+
+  glm::vec3 cameraPosition =
+      glm::vec3(playerPosition->x, playerPosition->y + cameraOffset.y,
+                playerPosition->z) -
+      forward * cameraOffset.z;
+
+  glm::vec3 cameraTarget =
+      glm::vec3(playerPosition->x, playerPosition->y + cameraOffset.y / 2.0f,
+                playerPosition->z);
+
+  // Pull the camera in front of anything between it and the player
+  if (physicsWorld) {
+    glm::vec3 toCamera = cameraPosition - cameraTarget;
+    float distance = glm::length(toCamera);
+    QueryHit hit;
+    if (physicsWorld->sphereCast(cameraTarget, CAMERA_RADIUS,
+                                 toCamera / distance, distance, hit, player)) {
+      cameraPosition = cameraTarget + toCamera / distance * hit.distance;
+    }
+  }
+
+  glm::mat4 view =
+      glm::lookAt(cameraPosition, cameraTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+
+  // Follow the window size
+  int height = viewportHeight == 0 ? 1 : viewportHeight;
+  float aspectRatio = (float)viewportWidth / (float)height;
+  glm::mat4 projection =
+      glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 1000.0f);
+
+  packet.hasCamera = true;
+  packet.frameData.projection = projection;
+  packet.frameData.view = view;
+  packet.frameData.lightDir = glm::normalize(glm::vec3(-0.5f, -1.0f, -0.3f));
+  packet.frameData.padding = 0.0f;
+  packet.frameData.lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+  packet.frameData.ambientStrength = AMBIENT_STRENGTH;
+
+  // Gather everything that needs to be drawn this frame
+  drawItems.clear();
+  componentManager.view<Renderable3D, Position, Material>(entityManager)
+      .each([&](EntityID entity, Renderable3D &renderable, Position &position,
+                Material &material) {
+        if (renderable.mesh == INVALID_MESH) {
+          return;
+        }
+        DrawItem item;
+        item.entity = entity;
+        item.renderable = &renderable;
+        item.position = &position;
+        item.material = &material;
+        // Retrieve optional rotation and scale components
+        item.rotation = componentManager.getComponent<Rotation>(entity);
+        item.scale = componentManager.getComponent<Scale>(entity);
+        drawItems.push_back(item);
+      });
+
+  // Build the model matrices and world bounds, then cull each range against
+  // the view frustum, in parallel
+  const Frustum frustum = Frustum::fromMatrix(projection * view);
+  drawBounds.resize(drawItems.size());
+  visibleIndices.resize(drawItems.size());
+  isVisible.assign(drawItems.size(), 0);
+  jobSystem->parallelFor(
+      drawItems.size(), TRANSFORM_GRAIN_SIZE,
+      [this, &frustum](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          DrawItem &item = drawItems[i];
+          glm::mat4 model = glm::mat4(1.0f);
+
+          // Apply scaling
+          if (item.scale) {
+            model = glm::scale(model, item.scale->scale);
+          }
+
+          // Apply rotation
+          if (item.rotation) {
+            model = model * glm::mat4_cast(item.rotation->quaternion);
+          }
+
+          // Apply translation
+          item.model = glm::translate(glm::mat4(1.0f),
+                                      glm::vec3(item.position->x,
+                                                item.position->y,
+                                                item.position->z)) *
+                       model;
+
+          const Mesh &mesh = meshRegistry->get(item.renderable->mesh);
+          drawBounds.set(i, mesh.bounds.transformed(item.model));
+        }
+
+        // Each range writes its own slice of the shared buffers
+        uint32_t *visible = visibleIndices.data() + begin;
+        size_t visibleCount =
+            frustumCullBatch(frustum, drawBounds, begin, end, visible);
+        for (size_t i = 0; i < visibleCount; ++i) {
+          isVisible[visible[i]] = 1;
+        }
+      });
+
+  // Keep only the visible items
+  size_t visibleCount = 0;
+  for (size_t i = 0; i < drawItems.size(); ++i) {
+    if (isVisible[i]) {
+      drawItems[visibleCount++] = drawItems[i];
+    }
+  }
+  packet.stats.visible = visibleCount;
+  packet.stats.culled = drawItems.size() - visibleCount;
+  drawItems.resize(visibleCount);
+
+  // Queue the visible items. Sorting groups them into one batch per shader
+  // and mesh, nearest first within a batch.
+  renderQueue.clear();
+  for (size_t i = 0; i < drawItems.size(); ++i) {
+    const DrawItem &item = drawItems[i];
+    float depth = -(view * item.model[3]).z;
+    renderQueue.push(RenderQueue::makeKey(RenderQueue::Pass::Opaque,
+                                          SHADER_3D, item.renderable->mesh,
+                                          materialKey(*item.material), depth),
+                     static_cast<uint32_t>(i));
+  }
+  renderQueue.sort();
+
+  // Lay the instances out in queue order and split them into batches
+  packet.instances.resize(renderQueue.size());
+  for (size_t i = 0; i < renderQueue.size(); ++i) {
+    const DrawItem &item = drawItems[renderQueue[i].item];
+    InstanceData &instance = packet.instances[i];
+    instance.model = item.model;
+    instance.color = item.material->diffuseColor;
+    instance.material = glm::vec2(item.material->specularStrength,
+                                  item.material->shininess);
+
+    // Handles too large for the key's mesh field share keys, so compare the
+    // meshes themselves too
+    MeshHandle mesh = item.renderable->mesh;
+    if (packet.batches.empty() ||
+        RenderQueue::batchOf(renderQueue[i].key) !=
+            RenderQueue::batchOf(renderQueue[i - 1].key) ||
+        packet.batches.back().mesh != mesh) {
+      packet.batches.push_back(RenderPacket::Batch{mesh, i, 0});
+    }
+    ++packet.batches.back().count;
+  }
+}
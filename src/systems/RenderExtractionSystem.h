@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../WindowConstants.h"
+#include "../components/Material.h"
+#include "../components/PlayerControlled.h"
+#include "../components/Position.h"
+#include "../components/Renderable.h"
+#include "../components/Rotation.h"
+#include "../components/Scale.h"
+#include "../core/Entity.h"
+#include "../core/JobSystem.h"
+#include "../core/System.h"
+#include "../managers/ComponentManager.h"
+#include "../managers/MeshRegistry.h"
+#include "../physics/PhysicsWorld.h"
+#include "../physics/SimdKernels.h"
+#include "../rendering/Frustum.h"
+#include "../rendering/RenderPacket.h"
+#include "../rendering/RenderQueue.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Turns the renderable entities into a RenderPacket: places the camera,
+// builds model matrices, culls against the view frustum and sorts the draws.
+// It only reads components and never calls GL, so it runs on a worker while
+// the RenderSystem draws the packet of the frame before.
+class RenderExtractionSystem : public System {
+public:
+  // Keeps the camera out of colliders if given the physics world
+  RenderExtractionSystem(JobSystem &jobSystem, const MeshRegistry &meshRegistry,
+                         const PhysicsWorld *physicsWorld = nullptr);
+
+  void update(float deltaTime, EntityManager &entityManager,
+              ComponentManager &componentManager) override;
+  // Publishes the packet extracted by the last update
+  void sync() override;
+
+  // Size of the framebuffer drawn to, read from the window by the main
+  // thread since GLFW must not be called from workers
+  void setViewport(int width, int height);
+
+  // Packet published at the last sync point. Stays unchanged while the
+  // next one is extracted.
+  const RenderPacket &latestPacket() const;
+
+private:
+  // Everything needed to draw one entity, gathered before culling
+  struct DrawItem {
+    EntityID entity;
+    const Renderable3D *renderable;
+    const Position *position;
+    const Material *material;
+    const Rotation *rotation;
+    const Scale *scale;
+    glm::mat4 model;
+  };
+
+  JobSystem *jobSystem;
+  const MeshRegistry *meshRegistry;
+  const PhysicsWorld *physicsWorld;
+  int viewportWidth;
+  int viewportHeight;
+  // The latest packet, and the one being extracted
+  std::array<RenderPacket, 2> packets;
+  size_t latest = 0;
+  // After culling, only the visible items
+  std::vector<DrawItem> drawItems;
+  // Visible items in draw order
+  RenderQueue renderQueue;
+  // World bounds of each gathered draw item, for the frustum test
+  AABBBatch drawBounds;
+  std::vector<uint32_t> visibleIndices;
+  std::vector<uint8_t> isVisible;
+};
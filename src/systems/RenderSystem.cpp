@@ -1,29 +1,43 @@
 #include "./RenderSystem.h"
 #include <iostream>
 
-RenderSystem::RenderSystem(GLFWwindow *win) : window(win) { initialize(); }
+// Uniform buffer binding point of the FrameData block
+const GLuint FRAME_DATA_BINDING = 0;
+
+RenderSystem::RenderSystem(const RenderExtractionSystem &extractionSystem,
+                           const MeshRegistry &meshes)
+    : extraction(&extractionSystem), meshRegistry(&meshes) {
+  // Needs the GL context, which is current on the main thread only. It reads
+  // no components, so it never waits for other systems.
+  setRunsOnMainThread(true);
+  glGenBuffers(1, &instanceVBO);
+
+  glGenBuffers(1, &frameUBO);
+  glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr,
+               GL_DYNAMIC_DRAW);
+  glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, frameUBO);
+
+  initialize();
+}
 
 RenderSystem::~RenderSystem() {
   delete shader3D;
-  for (auto &pair : VAOs3D) {
-    glDeleteVertexArrays(1, &pair.second);
-  }
-  for (auto &pair : VBOs3D) {
-    glDeleteBuffers(1, &pair.second);
+  glDeleteBuffers(1, &instanceVBO);
+  glDeleteBuffers(1, &frameUBO);
+  for (MeshBuffers &buffers : meshBuffers) {
+    glDeleteVertexArrays(1, &buffers.VAO);
+    glDeleteBuffers(1, &buffers.VBO);
+    glDeleteBuffers(1, &buffers.EBO);
   }
 }
 
+const RenderStats &RenderSystem::getStats() const { return stats; }
+
 void RenderSystem::reset() {
+  // Mesh buffers belong to the registry's meshes, which survive the reset
   delete shader3D;
-  for (auto &pair : VAOs3D) {
-    glDeleteVertexArrays(1, &pair.second);
-  }
-  for (auto &pair : VBOs3D) {
-    glDeleteBuffers(1, &pair.second);
-  }
-  VAOs3D.clear();
-  VBOs3D.clear();
-
+  stateCache.invalidate();
   initialize();
 }
 
@@ -31,20 +45,9 @@ void RenderSystem::initialize() {
   // Initialize shader for 3D rendering
   shader3D = new Shader("shaders/vertex_shader_3D.glsl",
                         "shaders/fragment_shader_3D.glsl");
-
-  // Set up the projection matrix (perspective projection for 3D objects)
-  float fov = glm::radians(45.0f);
-  int width, height;
-  glfwGetFramebufferSize(window, &width, &height);
-  float aspectRatio = (float)width / (float)height;
-  float nearPlane = 0.1f;
-  float farPlane = 10000.0f;
-
-  projection = glm::perspective(fov, aspectRatio, nearPlane, farPlane);
-
-  // Set up directional light properties
-  lightDirection = glm::normalize(glm::vec3(-0.5f, -1.0f, -0.3f));
-  lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+  if (!shader3D->bindUniformBlock("FrameData", FRAME_DATA_BINDING)) {
+    std::cerr << "Error: 3D shader has no FrameData block." << std::endl;
+  }
 
   // Enable depth testing
   glEnable(GL_DEPTH_TEST);
@@ -57,166 +60,108 @@ void RenderSystem::initialize() {
   glClearColor(0.53f, 0.81f, 0.98f, 1.0f);
 }
 
-void RenderSystem::update(float deltaTime, EntityManager &entityManager,
-                          ComponentManager &componentManager) {
+void RenderSystem::update(float, EntityManager &, ComponentManager &) {
   // Clear buffers
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  // Find the player entity
-  Position *playerPosition = nullptr;
-  Rotation *playerRotation = nullptr;
-
-  for (EntityID entity = 0; entity < entityManager.entityCount(); ++entity) {
-    const ComponentMask &mask = entityManager.getComponentMask(entity);
-    if (mask.test(ComponentType<PlayerControlled>::ID()) &&
-        mask.test(ComponentType<Position>::ID()) &&
-        mask.test(ComponentType<Rotation>::ID())) {
-      playerPosition = componentManager.getComponent<Position>(entity);
-      playerRotation = componentManager.getComponent<Rotation>(entity);
-      break;
-    }
-  }
-
-  if (playerPosition == nullptr || playerRotation == nullptr) {
-    std::cerr << "Error: No player entity found." << std::endl;
+  const RenderPacket &packet = extraction->latestPacket();
+  stats = packet.stats;
+  if (!packet.hasCamera) {
     return;
   }
 
-  // Set up the camera's view matrix
-  glm::vec3 cameraOffset(0.0f, 5.0f, 15.0f);
-
-  glm::vec3 forward = playerRotation->quaternion * glm::vec3(0.0f, 0.0f, -1.0f);
-  forward.y = 0.0f;
-  forward = glm::normalize(forward);
+  // Render 3D models
+  stateCache.useProgram(shader3D->ID);
+
+  // Upload the per-frame data once for every draw
+  glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &packet.frameData);
+
+  // Upload every instance at once; respecifying the store lets the driver
+  // hand out fresh memory instead of waiting on last frame's draws
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+  glBufferData(GL_ARRAY_BUFFER, packet.instances.size() * sizeof(InstanceData),
+               packet.instances.data(), GL_STREAM_DRAW);
+
+  // Issue one draw call per batch
+  for (const RenderPacket::Batch &batch : packet.batches) {
+    const MeshBuffers &buffers = uploadMesh(batch.mesh);
+    stateCache.bindVertexArray(buffers.VAO);
+    bindInstances(batch.first);
+    glDrawElementsInstanced(GL_TRIANGLES, buffers.indexCount, GL_UNSIGNED_INT,
+                            0, static_cast<GLsizei>(batch.count));
+  }
+  stateCache.bindVertexArray(0);
+}
 
-  glm::vec3 cameraPosition =
-      glm::vec3(playerPosition->x, playerPosition->y + cameraOffset.y,
-                playerPosition->z) -
-      forward * cameraOffset.z;
+const RenderSystem::MeshBuffers &RenderSystem::uploadMesh(MeshHandle mesh) {
+  if (mesh >= meshBuffers.size()) {
+    meshBuffers.resize(mesh + 1);
+  }
+  MeshBuffers &buffers = meshBuffers[mesh];
+  if (buffers.VAO != 0) {
+    return buffers;
+  }
 
-  glm::vec3 cameraTarget =
-      glm::vec3(playerPosition->x, playerPosition->y + cameraOffset.y / 2.0f,
-                playerPosition->z);
+  const Mesh &data = meshRegistry->get(mesh);
+  glGenVertexArrays(1, &buffers.VAO);
+  glGenBuffers(1, &buffers.VBO);
+  glGenBuffers(1, &buffers.EBO);
+  buffers.indexCount = static_cast<GLsizei>(data.indices.size());
+
+  stateCache.bindVertexArray(buffers.VAO);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
+
+  // Interleave positions and normals
+  std::vector<float> vertexData;
+  vertexData.reserve(data.vertices.size() * 6);
+  for (size_t i = 0; i < data.vertices.size(); ++i) {
+    vertexData.push_back(data.vertices[i].x);
+    vertexData.push_back(data.vertices[i].y);
+    vertexData.push_back(data.vertices[i].z);
+    vertexData.push_back(data.normals[i].x);
+    vertexData.push_back(data.normals[i].y);
+    vertexData.push_back(data.normals[i].z);
+  }
 
-  glm::mat4 view =
-      glm::lookAt(cameraPosition, cameraTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+  glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float),
+               vertexData.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.EBO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(GLuint),
+               data.indices.data(), GL_STATIC_DRAW);
+
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+                        (void *)0);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+                        (void *)(3 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+
+  // Instance attributes advance once per instance; their pointers are set
+  // by bindInstances for each draw
+  for (GLuint location = 2; location <= 7; ++location) {
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+  }
 
-  // Update the projection matrix if the window size changes
-  int width, height;
-  glfwGetFramebufferSize(window, &width, &height);
-  if (height == 0)
-    height = 1; // Prevent division by zero
-  float aspectRatio = (float)width / (float)height;
-  projection =
-      glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 1000.0f);
+  stateCache.bindVertexArray(0);
+  return buffers;
+}
 
-  // Render 3D models
-  shader3D->use();
-  shader3D->setMat4("projection", glm::value_ptr(projection));
-  shader3D->setMat4("view", glm::value_ptr(view));
-
-  shader3D->setVec3("lightDir", lightDirection.x, lightDirection.y,
-                    lightDirection.z);
-  shader3D->setVec3("lightColor", lightColor.r, lightColor.g, lightColor.b);
-  shader3D->setFloat("ambientStrength", 0.5f);
-
-  for (EntityID entity = 0; entity < entityManager.entityCount(); ++entity) {
-    const ComponentMask &mask = entityManager.getComponentMask(entity);
-
-    if (mask.test(ComponentType<Renderable3D>::ID()) &&
-        mask.test(ComponentType<Position>::ID()) &&
-        mask.test(ComponentType<Material>::ID())) {
-      auto *position = componentManager.getComponent<Position>(entity);
-      auto *renderable = componentManager.getComponent<Renderable3D>(entity);
-      auto *material = componentManager.getComponent<Material>(entity);
-
-      // Retrieve rotation component if it exists
-      Rotation *rotation = nullptr;
-      if (mask.test(ComponentType<Rotation>::ID())) {
-        rotation = componentManager.getComponent<Rotation>(entity);
-      }
-
-      // Retrieve scale component if it exists
-      Scale *scaleComp = nullptr;
-      if (mask.test(ComponentType<Scale>::ID())) {
-        scaleComp = componentManager.getComponent<Scale>(entity);
-      }
-
-      if (position && renderable && material) {
-        // Initialize VAO and VBO if not already done
-        if (VAOs3D.find(entity) == VAOs3D.end()) {
-          GLuint VAO, VBO, EBO;
-          glGenVertexArrays(1, &VAO);
-          glGenBuffers(1, &VBO);
-          glGenBuffers(1, &EBO);
-
-          glBindVertexArray(VAO);
-          glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-          std::vector<float> vertexData;
-          for (size_t i = 0; i < renderable->vertices.size(); ++i) {
-            vertexData.push_back(renderable->vertices[i].x);
-            vertexData.push_back(renderable->vertices[i].y);
-            vertexData.push_back(renderable->vertices[i].z);
-            vertexData.push_back(renderable->normals[i].x);
-            vertexData.push_back(renderable->normals[i].y);
-            vertexData.push_back(renderable->normals[i].z);
-          }
-
-          glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float),
-                       vertexData.data(), GL_STATIC_DRAW);
-          glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-          glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                       renderable->indices.size() * sizeof(GLuint),
-                       &renderable->indices[0], GL_STATIC_DRAW);
-
-          glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-                                (void *)0);
-          glEnableVertexAttribArray(0);
-          glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-                                (void *)(3 * sizeof(float)));
-          glEnableVertexAttribArray(1);
-
-          glBindVertexArray(0);
-
-          VAOs3D[entity] = VAO;
-          VBOs3D[entity] = VBO;
-        }
-
-        // Build the model matrix
-        glm::mat4 model = glm::mat4(1.0f);
-
-        // Apply scaling
-        if (scaleComp) {
-          model = glm::scale(model, scaleComp->scale);
-        }
-
-        // Apply rotation
-        if (rotation) {
-          model = model * glm::mat4_cast(rotation->quaternion);
-        }
-
-        // Apply translation
-        model =
-            glm::translate(glm::mat4(1.0f),
-                           glm::vec3(position->x, position->y, position->z)) *
-            model;
-
-        // Set the model matrix in the shader
-        shader3D->setMat4("model", glm::value_ptr(model));
-
-        // Set material properties
-        shader3D->setVec3("objectColor", material->diffuseColor.r,
-                          material->diffuseColor.g, material->diffuseColor.b);
-        shader3D->setFloat("specularStrength", material->specularStrength);
-        shader3D->setFloat("shininess", material->shininess);
-
-        // Render the model
-        glBindVertexArray(VAOs3D[entity]);
-        glDrawElements(GL_TRIANGLES, renderable->indices.size(),
-                       GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-      }
-    }
+void RenderSystem::bindInstances(size_t first) {
+  // GL 3.3 has no base instance for draws, so offset the pointers instead
+  const size_t base = first * sizeof(InstanceData);
+  const GLsizei stride = sizeof(InstanceData);
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+  // A mat4 attribute takes one location per column
+  for (GLuint column = 0; column < 4; ++column) {
+    glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, stride,
+                          (void *)(base + offsetof(InstanceData, model) +
+                                   column * sizeof(glm::vec4)));
   }
+  glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, stride,
+                        (void *)(base + offsetof(InstanceData, color)));
+  glVertexAttribPointer(7, 2, GL_FLOAT, GL_FALSE, stride,
+                        (void *)(base + offsetof(InstanceData, material)));
 }
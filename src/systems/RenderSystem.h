@@ -1,40 +1,59 @@
 #pragma once
 
 #include "../Shader.h"
-#include "../WindowConstants.h"
-#include "../components/Material.h"
-#include "../components/PlayerControlled.h"
-#include "../components/Position.h"
-#include "../components/Renderable.h"
-#include "../components/Rotation.h"
-#include "../components/Scale.h"
 #include "../core/Entity.h"
+#include "../core/System.h"
 #include "../managers/ComponentManager.h"
+#include "../managers/MeshRegistry.h"
+#include "../rendering/GLStateCache.h"
+#include "../rendering/RenderPacket.h"
+#include "../systems/RenderExtractionSystem.h"
 #include "glad/glad.h"
-#include <GLFW/glfw3.h>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-#include <unordered_map>
+#include <cstddef>
+#include <vector>
 
-class RenderSystem {
+// Draws the packets of a RenderExtractionSystem. It touches no components,
+// only GL, so it runs on the main thread alongside the extraction of the
+// next frame and draws the packet published at the last sync point.
+class RenderSystem : public System {
 public:
-  RenderSystem(GLFWwindow *window);
+  RenderSystem(const RenderExtractionSystem &extraction,
+               const MeshRegistry &meshRegistry);
   ~RenderSystem();
 
   void update(float deltaTime, EntityManager &entityManager,
-              ComponentManager &componentManager);
+              ComponentManager &componentManager) override;
 
   void reset();
 
+  // Stats of the last packet drawn
+  const RenderStats &getStats() const;
+
 private:
-  GLFWwindow *window;
+  // GPU copy of a registry mesh, shared by every entity drawing it
+  struct MeshBuffers {
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    GLuint EBO = 0;
+    GLsizei indexCount = 0;
+  };
+
+  const RenderExtractionSystem *extraction;
+  const MeshRegistry *meshRegistry;
   Shader *shader3D;
-  glm::mat4 projection;
-  glm::vec3 lightDirection;
-  glm::vec3 lightColor;
-  std::unordered_map<EntityID, GLuint> VAOs3D;
-  std::unordered_map<EntityID, GLuint> VBOs3D;
+  // Indexed by MeshHandle; VAO is 0 until the mesh is first drawn
+  std::vector<MeshBuffers> meshBuffers;
+  GLStateCache stateCache;
+  RenderStats stats;
+  // Holds the instances of every mesh drawn this frame
+  GLuint instanceVBO;
+  // Uniform buffer holding this frame's FrameData
+  GLuint frameUBO;
 
   void initialize();
+  // Buffers of the mesh, uploaded the first time it is drawn
+  const MeshBuffers &uploadMesh(MeshHandle mesh);
+  // Points the instance attributes of the bound VAO at the instance buffer,
+  // starting from instance first
+  void bindInstances(size_t first);
 };
@@ -0,0 +1,250 @@
+#include "Check.h"
+#include "components/Asleep.h"
+#include "components/Collidable.h"
+#include "components/Position.h"
+#include "components/Velocity.h"
+#include "managers/ComponentManager.h"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace {
+ComponentMask maskOf(std::initializer_list<size_t> componentIDs) {
+  ComponentMask mask;
+  for (size_t id : componentIDs) {
+    mask.set(id);
+  }
+  return mask;
+}
+
+const size_t POSITION = ComponentType<Position>::ID();
+const size_t VELOCITY = ComponentType<Velocity>::ID();
+
+// Rows fill 16 KB chunks front to back with aligned columns
+void testChunkLayout() {
+  EntityManager entityManager;
+  ArchetypeManager archetypes;
+  std::vector<EntityID> entities;
+  for (int i = 0; i < 2000; ++i) {
+    EntityID entity = entityManager.createEntity();
+    archetypes.emplaceComponent<Position>(entity, entityManager, float(i),
+                                          0.0f, 0.0f);
+    archetypes.emplaceComponent<Velocity>(entity, entityManager, 0.0f,
+                                          float(i), 0.0f);
+    entities.push_back(entity);
+  }
+  // The Position-only archetype each entity passed through stays, empty
+  CHECK(archetypes.archetypeCount() == 2);
+
+  size_t chunks = 0;
+  size_t rows = 0;
+  size_t capacity = 0;
+  archetypes.eachChunk(
+      maskOf({POSITION, VELOCITY}), ComponentMask(),
+      [&](Archetype &archetype, size_t chunk) {
+        capacity = archetype.chunkCapacity();
+        CHECK(capacity * (sizeof(EntityID) + sizeof(Position) +
+                          sizeof(Velocity)) <=
+              ARCHETYPE_CHUNK_SIZE);
+        // Every chunk but the last one is full
+        CHECK(chunk + 1 == archetype.chunkCount() ||
+              archetype.chunkSize(chunk) == capacity);
+        for (size_t id : {POSITION, VELOCITY}) {
+          CHECK(reinterpret_cast<uintptr_t>(archetype.column(id, chunk)) %
+                    ARCHETYPE_CHUNK_ALIGNMENT ==
+                0);
+        }
+
+        const EntityID *ids = archetype.entities(chunk);
+        auto *positions =
+            static_cast<Position *>(archetype.column(POSITION, chunk));
+        auto *velocities =
+            static_cast<Velocity *>(archetype.column(VELOCITY, chunk));
+        for (size_t i = 0; i < archetype.chunkSize(chunk); ++i) {
+          CHECK(ids[i] == entities[rows + i]);
+          CHECK(positions[i].x == float(rows + i));
+          CHECK(velocities[i].dy == float(rows + i));
+        }
+        rows += archetype.chunkSize(chunk);
+        ++chunks;
+      });
+  CHECK(rows == entities.size());
+  CHECK(capacity > 1);
+  CHECK(chunks == (entities.size() + capacity - 1) / capacity);
+
+  // Excluded components skip whole archetypes
+  size_t visited = 0;
+  archetypes.eachChunk(maskOf({POSITION}), maskOf({VELOCITY}),
+                       [&](Archetype &, size_t) { ++visited; });
+  CHECK(visited == 0);
+}
+
+// Removing rows and components moves entities without losing their data
+void testRowRelocation() {
+  EntityManager entityManager;
+  ArchetypeManager archetypes;
+  std::map<EntityID, float> expected;
+  for (int i = 0; i < 1000; ++i) {
+    EntityID entity = entityManager.createEntity();
+    archetypes.emplaceComponent<Position>(entity, entityManager, float(i),
+                                          0.0f, 0.0f);
+    archetypes.emplaceComponent<Velocity>(entity, entityManager);
+    expected[entity] = float(i);
+  }
+
+  std::vector<EntityID> moved;
+  for (auto it = expected.begin(); it != expected.end();) {
+    EntityID entity = it->first;
+    if (entityIndex(entity) % 3 == 0) {
+      archetypes.destroyEntity(entity, entityManager);
+      it = expected.erase(it);
+      continue;
+    }
+    if (entityIndex(entity) % 3 == 1) {
+      archetypes.removeComponent<Velocity>(entity, entityManager);
+      moved.push_back(entity);
+    }
+    ++it;
+  }
+
+  for (const auto &[entity, x] : expected) {
+    Position *position = archetypes.getComponent<Position>(entity);
+    CHECK(position && position->x == x);
+    bool hasVelocity = entityIndex(entity) % 3 == 2;
+    CHECK((archetypes.getComponent<Velocity>(entity) != nullptr) ==
+          hasVelocity);
+    CHECK(entityManager.getComponentMask(entity).test(VELOCITY) ==
+          hasVelocity);
+  }
+
+  size_t positionOnly = 0;
+  archetypes.eachChunk(maskOf({POSITION}), maskOf({VELOCITY}),
+                       [&](Archetype &archetype, size_t chunk) {
+                         positionOnly += archetype.chunkSize(chunk);
+                       });
+  CHECK(positionOnly == moved.size());
+
+  // Removing the last component drops the row
+  archetypes.removeComponent<Position>(moved[0], entityManager);
+  CHECK(!archetypes.getComponent<Position>(moved[0]));
+  CHECK(entityManager.getComponentMask(moved[0]).none());
+  CHECK(archetypes.getComponent<Position>(moved[1])->x == expected[moved[1]]);
+}
+
+// Dead entities and stale handles never reach the archetypes
+void testRejectsDeadEntities() {
+  EntityManager entityManager;
+  ArchetypeManager archetypes;
+  EntityID stale = entityManager.createEntity();
+  CHECK(archetypes.emplaceComponent<Position>(stale, entityManager));
+  archetypes.destroyEntity(stale, entityManager);
+
+  EntityID entity = entityManager.createEntity();
+  CHECK(entityIndex(entity) == entityIndex(stale));
+  archetypes.emplaceComponent<Position>(entity, entityManager, 2.0f, 0.0f,
+                                        0.0f);
+
+  CHECK(!archetypes.emplaceComponent<Position>(stale, entityManager, 3.0f,
+                                               0.0f, 0.0f));
+  CHECK(!archetypes.emplaceComponent<Velocity>(stale, entityManager));
+  archetypes.removeComponent<Position>(stale, entityManager);
+  archetypes.destroyEntity(stale, entityManager);
+  CHECK(!archetypes.getComponent<Position>(stale));
+
+  CHECK(entityManager.isAlive(entity));
+  CHECK(archetypes.getComponent<Position>(entity)->x == 2.0f);
+  CHECK(!archetypes.getComponent<Velocity>(entity));
+  CHECK(entityManager.getComponentMask(entity) == maskOf({POSITION}));
+}
+
+// Views over archetype storage see the same entities as over pools
+void testViewsMatchSparseSet() {
+  EntityManager entityManagers[2];
+  ComponentManager componentManagers[2] = {
+      ComponentManager(StorageMode::SparseSet),
+      ComponentManager(StorageMode::Archetype)};
+  CHECK(componentManagers[1].storageMode() == StorageMode::Archetype);
+
+  std::mt19937 rng(3);
+  for (int i = 0; i < 3000; ++i) {
+    unsigned roll = rng();
+    for (int storage = 0; storage < 2; ++storage) {
+      EntityManager &entityManager = entityManagers[storage];
+      ComponentManager &componentManager = componentManagers[storage];
+      EntityID entity = entityManager.createEntity();
+      componentManager.addComponent(entity, Position(float(i), 0.0f, 0.0f),
+                                    entityManager);
+      if (roll % 2) {
+        componentManager.addComponent(entity, Velocity(), entityManager);
+      }
+      if (roll % 3 == 0) {
+        componentManager.addComponent(entity, Collidable(), entityManager);
+      }
+      if (roll % 5 == 0) {
+        componentManager.addComponent(entity, Asleep(), entityManager);
+      }
+      if (roll % 7 == 0) {
+        componentManager.destroyEntity(entity, entityManager);
+      }
+    }
+  }
+
+  JobSystem jobSystem(2);
+  std::vector<EntityID> found[2][3];
+  for (int storage = 0; storage < 2; ++storage) {
+    EntityManager &entityManager = entityManagers[storage];
+    ComponentManager &componentManager = componentManagers[storage];
+    componentManager.view<Position, Velocity>(entityManager)
+        .exclude<Asleep>()
+        .each([&](EntityID entity, Position &position, Velocity &velocity) {
+          velocity.dx = position.x;
+          found[storage][0].push_back(entity);
+        });
+    componentManager.view<Collidable, Position>(entityManager)
+        .each([&](EntityID entity, Collidable &, Position &) {
+          found[storage][1].push_back(entity);
+        });
+
+    std::mutex mutex;
+    componentManager.view<Velocity>(entityManager)
+        .parallelEach(jobSystem, 64, [&](EntityID entity, Velocity &) {
+          std::lock_guard<std::mutex> lock(mutex);
+          found[storage][2].push_back(entity);
+        });
+  }
+
+  for (int query = 0; query < 3; ++query) {
+    for (auto &entities : found) {
+      std::sort(entities[query].begin(), entities[query].end());
+    }
+    CHECK(!found[0][query].empty());
+    CHECK(found[0][query] == found[1][query]);
+  }
+  for (EntityID entity : found[1][0]) {
+    CHECK(componentManagers[1].getComponent<Velocity>(entity)->dx ==
+          componentManagers[1].getComponent<Position>(entity)->x);
+  }
+}
+
+void testStorageModeNames() {
+  StorageMode mode = StorageMode::SparseSet;
+  CHECK(parseStorageMode("archetype", mode));
+  CHECK(mode == StorageMode::Archetype);
+  CHECK(parseStorageMode("sparse", mode));
+  CHECK(mode == StorageMode::SparseSet);
+  CHECK(!parseStorageMode("chunks", mode));
+  CHECK(mode == StorageMode::SparseSet);
+}
+} // unnamed namespace
+
+int main() {
+  testChunkLayout();
+  testRowRelocation();
+  testRejectsDeadEntities();
+  testViewsMatchSparseSet();
+  testStorageModeNames();
+  return testResult("ArchetypeTest");
+}
@@ -0,0 +1,301 @@
+#include "Check.h"
+#include "physics/Broadphase.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+const BroadphaseType TYPES[] = {BroadphaseType::DynamicTree,
+                                BroadphaseType::SpatialHashGrid,
+                                BroadphaseType::SweepAndPrune};
+
+// Random boxes, some of them with faces on the grid's cell boundaries
+AABB randomBox(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+  std::uniform_real_distribution<float> size(0.1f, 10.0f);
+  glm::vec3 min(position(rng), position(rng), position(rng));
+  if (rng() % 4 == 0) {
+    min = glm::floor(min / 8.0f) * 8.0f;
+  }
+  return AABB(min, min + glm::vec3(size(rng), size(rng), size(rng)));
+}
+
+// The broadphase and the boxes it should hold after random edits
+struct Scene {
+  std::unique_ptr<Broadphase> broadphase;
+  std::map<EntityID, AABB> boxes;
+};
+
+Scene buildScene(BroadphaseType type, std::mt19937 &rng) {
+  Scene scene{createBroadphase(type), {}};
+  for (EntityID entity = 0; entity < 300; ++entity) {
+    AABB box = randomBox(rng);
+    bool isStatic = entity % 3 == 0;
+    scene.broadphase->insertProxy(entity, box, isStatic);
+    scene.boxes[entity] = box;
+  }
+  for (EntityID entity = 0; entity < 300; ++entity) {
+    if (entity % 5 == 0) {
+      scene.broadphase->removeProxy(entity);
+      scene.boxes.erase(entity);
+    } else if (entity % 3 != 0) {
+      AABB box = scene.boxes[entity];
+      glm::vec3 offset = entity % 2 ? glm::vec3(0.05f) : glm::vec3(-20.0f);
+      box = AABB(box.min + offset, box.max + offset);
+      scene.broadphase->moveProxy(entity, box);
+      scene.boxes[entity] = box;
+    }
+  }
+  return scene;
+}
+
+void testQueryMatchesBruteForce(BroadphaseType type) {
+  std::mt19937 rng(4);
+  Scene scene = buildScene(type, rng);
+  for (const auto &[entity, box] : scene.boxes) {
+    CHECK(scene.broadphase->hasProxy(entity));
+  }
+  CHECK(!scene.broadphase->hasProxy(5));
+
+  for (int q = 0; q < 200; ++q) {
+    AABB query = randomBox(rng);
+    std::vector<EntityID> expected;
+    for (const auto &[entity, box] : scene.boxes) {
+      if (box.overlaps(query)) {
+        expected.push_back(entity);
+      }
+    }
+    std::vector<EntityID> results;
+    scene.broadphase->query(query, results);
+    std::sort(results.begin(), results.end());
+    CHECK(results == expected);
+  }
+
+  scene.broadphase->clear();
+  std::vector<EntityID> results;
+  scene.broadphase->query(AABB(glm::vec3(-1e3f), glm::vec3(1e3f)), results);
+  CHECK(results.empty());
+}
+
+glm::vec3 randomDirection(std::mt19937 &rng, int ray) {
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  glm::vec3 direction(unit(rng), unit(rng), unit(rng));
+  // Also walk along the axes and planes, where DDA steps are infinite
+  if (ray % 5 == 1) {
+    direction.y = direction.z = 0.0f;
+  } else if (ray % 5 == 2) {
+    direction.x = 0.0f;
+  }
+  if (glm::length(direction) < 1e-3f) {
+    direction = glm::vec3(0.0f, 0.0f, -1.0f);
+  }
+  return glm::normalize(direction);
+}
+
+void testRaycastMatchesBruteForce(BroadphaseType type) {
+  std::mt19937 rng(5);
+  Scene scene = buildScene(type, rng);
+  std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+
+  for (int ray = 0; ray < 300; ++ray) {
+    glm::vec3 origin(position(rng), position(rng), position(rng));
+    glm::vec3 direction = randomDirection(rng, ray);
+    const float maxDistance = 100.0f;
+
+    std::map<EntityID, float> expected;
+    float nearest = maxDistance;
+    for (const auto &[entity, box] : scene.boxes) {
+      float distance;
+      if (box.raycast(origin, direction, maxDistance, distance)) {
+        expected[entity] = distance;
+        nearest = std::min(nearest, distance);
+      }
+    }
+
+    // Without clipping every proxy on the ray is reported once
+    std::map<EntityID, float> reported;
+    size_t calls = 0;
+    scene.broadphase->raycast(origin, direction, maxDistance,
+                              [&](const RaycastHit &hit) {
+                                ++calls;
+                                reported[hit.entity] = hit.distance;
+                                return maxDistance;
+                              });
+    CHECK(calls == reported.size());
+    CHECK(reported.size() == expected.size());
+    for (const auto &[entity, distance] : expected) {
+      auto found = reported.find(entity);
+      CHECK(found != reported.end());
+      if (found != reported.end()) {
+        CHECK(std::abs(found->second - distance) < 1e-3f);
+      }
+    }
+
+    // Clipping at each hit still finds the nearest one
+    float closest = maxDistance;
+    bool hit = false;
+    scene.broadphase->raycast(origin, direction, maxDistance,
+                              [&](const RaycastHit &candidate) {
+                                hit = true;
+                                closest = std::min(closest, candidate.distance);
+                                return closest;
+                              });
+    CHECK(hit == !expected.empty());
+    if (hit && !expected.empty()) {
+      CHECK(std::abs(closest - nearest) < 1e-3f);
+    }
+
+    // Returning 0 stops the cast
+    calls = 0;
+    scene.broadphase->raycast(origin, direction, maxDistance,
+                              [&](const RaycastHit &) {
+                                ++calls;
+                                return 0.0f;
+                              });
+    CHECK(calls == (expected.empty() ? 0u : 1u));
+  }
+}
+
+// Sweeping a box reports the proxies a ray hits once grown by its extent
+void testSweepBoxMatchesBruteForce(BroadphaseType type) {
+  std::mt19937 rng(6);
+  Scene scene = buildScene(type, rng);
+  std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> size(0.0f, 12.0f);
+
+  for (int ray = 0; ray < 200; ++ray) {
+    glm::vec3 origin(position(rng), position(rng), position(rng));
+    glm::vec3 direction = randomDirection(rng, ray);
+    // Some boxes are wider than all the cells in use
+    glm::vec3 extent = ray % 20 == 0 ? glm::vec3(100.0f)
+                                     : glm::vec3(size(rng), size(rng),
+                                                 size(rng));
+    const float maxDistance = 100.0f;
+
+    std::map<EntityID, float> expected;
+    float nearest = maxDistance;
+    for (const auto &[entity, box] : scene.boxes) {
+      float distance;
+      if (AABB(box.min - extent, box.max + extent)
+              .raycast(origin, direction, maxDistance, distance)) {
+        expected[entity] = distance;
+        nearest = std::min(nearest, distance);
+      }
+    }
+
+    std::map<EntityID, float> reported;
+    size_t calls = 0;
+    scene.broadphase->sweepBox(origin, extent, direction, maxDistance,
+                               [&](const RaycastHit &hit) {
+                                 ++calls;
+                                 reported[hit.entity] = hit.distance;
+                                 return maxDistance;
+                               });
+    CHECK(calls == reported.size());
+    CHECK(reported.size() == expected.size());
+    for (const auto &[entity, distance] : expected) {
+      auto found = reported.find(entity);
+      CHECK(found != reported.end());
+      if (found != reported.end()) {
+        CHECK(std::abs(found->second - distance) < 1e-3f);
+      }
+    }
+
+    float closest = maxDistance;
+    bool hit = false;
+    scene.broadphase->sweepBox(origin, extent, direction, maxDistance,
+                               [&](const RaycastHit &candidate) {
+                                 hit = true;
+                                 closest =
+                                     std::min(closest, candidate.distance);
+                                 return closest;
+                               });
+    CHECK(hit == !expected.empty());
+    if (hit && !expected.empty()) {
+      CHECK(std::abs(closest - nearest) < 1e-3f);
+    }
+  }
+}
+
+// Unbounded rays, zero directions and huge boxes must not stall the grid
+void testGridBounds() {
+  std::unique_ptr<Broadphase> grid =
+      createBroadphase(BroadphaseType::SpatialHashGrid);
+  const float infinity = std::numeric_limits<float>::infinity();
+  grid->insertProxy(1, AABB(glm::vec3(10.0f), glm::vec3(12.0f)), true);
+  grid->insertProxy(2, AABB(glm::vec3(-1e7f), glm::vec3(1e7f)), true);
+  grid->insertProxy(3, AABB(glm::vec3(500.0f), glm::vec3(501.0f)), false);
+
+  std::vector<EntityID> results;
+  grid->query(AABB(glm::vec3(-infinity), glm::vec3(infinity)), results);
+  std::sort(results.begin(), results.end());
+  CHECK(results == std::vector<EntityID>({1, 2, 3}));
+  results.clear();
+  grid->query(AABB(glm::vec3(-1.0f), glm::vec3(1.0f)), results);
+  CHECK(results == std::vector<EntityID>({2}));
+
+  std::vector<EntityID> hits;
+  auto record = [&](const RaycastHit &hit) {
+    hits.push_back(hit.entity);
+    return infinity;
+  };
+  grid->raycast(glm::vec3(0.0f), glm::normalize(glm::vec3(1.0f)), infinity,
+                record);
+  std::sort(hits.begin(), hits.end());
+  CHECK(hits == std::vector<EntityID>({1, 2, 3}));
+
+  // Rays starting outside the occupied cells, or missing them, end too
+  hits.clear();
+  grid->raycast(glm::vec3(-1e6f, 11.0f, 11.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+                infinity, record);
+  std::sort(hits.begin(), hits.end());
+  CHECK(hits == std::vector<EntityID>({1, 2}));
+  hits.clear();
+  grid->raycast(glm::vec3(0.0f, 1e3f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+                infinity, record);
+  CHECK(hits == std::vector<EntityID>({2}));
+
+  // A zero direction only tests the origin
+  hits.clear();
+  grid->raycast(glm::vec3(11.0f), glm::vec3(0.0f), infinity, record);
+  std::sort(hits.begin(), hits.end());
+  CHECK(hits == std::vector<EntityID>({1, 2}));
+
+  // Moving the huge box back into the cells keeps it queryable
+  grid->moveProxy(2, AABB(glm::vec3(-1.0f), glm::vec3(1.0f)));
+  results.clear();
+  grid->query(AABB(glm::vec3(-2.0f), glm::vec3(2.0f)), results);
+  CHECK(results == std::vector<EntityID>({2}));
+  grid->removeProxy(2);
+  results.clear();
+  grid->query(AABB(glm::vec3(-1e9f), glm::vec3(1e9f)), results);
+  std::sort(results.begin(), results.end());
+  CHECK(results == std::vector<EntityID>({1, 3}));
+}
+
+void testTypeNames() {
+  BroadphaseType type = BroadphaseType::DynamicTree;
+  CHECK(parseBroadphaseType("grid", type));
+  CHECK(type == BroadphaseType::SpatialHashGrid);
+  CHECK(parseBroadphaseType("sap", type));
+  CHECK(type == BroadphaseType::SweepAndPrune);
+  CHECK(parseBroadphaseType("tree", type));
+  CHECK(type == BroadphaseType::DynamicTree);
+  CHECK(!parseBroadphaseType("octree", type));
+  CHECK(type == BroadphaseType::DynamicTree);
+}
+} // unnamed namespace
+
+int main() {
+  for (BroadphaseType type : TYPES) {
+    testQueryMatchesBruteForce(type);
+    testRaycastMatchesBruteForce(type);
+    testSweepBoxMatchesBruteForce(type);
+  }
+  testGridBounds();
+  testTypeNames();
+  return testResult("BroadphaseTest");
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal test harness. CHECK reports a failed condition and keeps going, so
+// one run shows every failure. Each test program returns testResult() from
+// main, which is non-zero if any check failed.
+inline int &checkFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define CHECK(condition)                                                     \
+  do {                                                                       \
+    if (!(condition)) {                                                      \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                   #condition);                                              \
+      ++checkFailures();                                                     \
+    }                                                                        \
+  } while (false)
+
+inline int testResult(const char *name) {
+  if (checkFailures() == 0) {
+    std::printf("%s: passed\n", name);
+    return 0;
+  }
+  std::printf("%s: %d check(s) failed\n", name, checkFailures());
+  return 1;
+}
@@ -0,0 +1,116 @@
+#include "Check.h"
+#include "components/Collidable.h"
+#include "components/Position.h"
+#include "components/Velocity.h"
+#include "managers/CommandBuffer.h"
+
+namespace {
+// Commands on a placeholder apply to the entity created for it on playback
+void testPlaceholdersResolveOnPlayback() {
+  EntityManager entityManager;
+  ComponentManager componentManager;
+  CommandBuffer commands;
+
+  EntityID first = commands.createEntity();
+  EntityID second = commands.createEntity();
+  commands.addComponent(first, Position(7.0f, 0.0f, 0.0f));
+  commands.addComponent(first, Collidable());
+  commands.addComponent(second, Velocity(1.0f, 2.0f, 3.0f));
+  CHECK(!commands.empty());
+  CHECK(entityManager.entityCount() == 0);
+  CHECK(!entityManager.isAlive(first));
+
+  commands.playback(entityManager, componentManager);
+  CHECK(commands.empty());
+  CHECK(entityManager.entityCount() == 2);
+
+  size_t positions = 0;
+  componentManager.view<Position, Collidable>(entityManager)
+      .each([&](EntityID entity, Position &position, Collidable &) {
+        ++positions;
+        CHECK(entityManager.isAlive(entity));
+        CHECK(position.x == 7.0f);
+        CHECK(!componentManager.getComponent<Velocity>(entity));
+      });
+  CHECK(positions == 1);
+
+  size_t velocities = 0;
+  componentManager.view<Velocity>(entityManager)
+      .each([&](EntityID entity, Velocity &velocity) {
+        ++velocities;
+        CHECK(velocity.dy == 2.0f);
+        CHECK(!componentManager.getComponent<Position>(entity));
+      });
+  CHECK(velocities == 1);
+}
+
+// Commands run in recording order; those aimed at an entity destroyed by an
+// earlier command are dropped
+void testCommandsAfterDestroyAreDropped() {
+  EntityManager entityManager;
+  ComponentManager componentManager;
+  CommandBuffer commands;
+
+  EntityID entity = entityManager.createEntity();
+  componentManager.addComponent(entity, Position(), entityManager);
+  commands.removeComponent<Position>(entity);
+  commands.destroyEntity(entity);
+  commands.addComponent(entity, Velocity());
+  // The slot may be reused on playback, but not by this handle
+  EntityID created = commands.createEntity();
+  commands.addComponent(created, Position(1.0f, 0.0f, 0.0f));
+  commands.playback(entityManager, componentManager);
+
+  CHECK(!entityManager.isAlive(entity));
+  CHECK(!componentManager.getComponent<Velocity>(entity));
+  CHECK(!componentManager.getComponent<Position>(entity));
+  size_t velocities = 0;
+  componentManager.view<Velocity>(entityManager)
+      .each([&](EntityID, Velocity &) { ++velocities; });
+  CHECK(velocities == 0);
+  size_t positions = 0;
+  componentManager.view<Position>(entityManager)
+      .each([&](EntityID, Position &position) {
+        ++positions;
+        CHECK(position.x == 1.0f);
+      });
+  CHECK(positions == 1);
+}
+
+// A placeholder only means something to the buffer that made it, and only
+// until that buffer's next playback
+void testForeignPlaceholdersAreDropped() {
+  EntityManager entityManager;
+  ComponentManager componentManager;
+  CommandBuffer other;
+  EntityID foreign = other.createEntity();
+  other.createEntity();
+  EntityID late = other.createEntity();
+
+  CommandBuffer commands;
+  EntityID created = commands.createEntity();
+  commands.addComponent(created, Position());
+  commands.addComponent(late, Velocity());
+  commands.destroyEntity(foreign);
+  commands.playback(entityManager, componentManager);
+  CHECK(entityManager.entityCount() == 1);
+
+  // Reusing a placeholder after playback creates nothing new
+  commands.addComponent(created, Velocity());
+  commands.destroyEntity(created);
+  commands.playback(entityManager, componentManager);
+  CHECK(entityManager.entityCount() == 1);
+
+  size_t velocities = 0;
+  componentManager.view<Velocity>(entityManager)
+      .each([&](EntityID, Velocity &) { ++velocities; });
+  CHECK(velocities == 0);
+}
+} // unnamed namespace
+
+int main() {
+  testPlaceholdersResolveOnPlayback();
+  testCommandsAfterDestroyAreDropped();
+  testForeignPlaceholdersAreDropped();
+  return testResult("CommandBufferTest");
+}
@@ -0,0 +1,151 @@
+#include "Check.h"
+#include "physics/DynamicAABBTree.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+AABB randomBox(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+  std::uniform_real_distribution<float> size(0.1f, 4.0f);
+  glm::vec3 min(position(rng), position(rng), position(rng));
+  return AABB(min, min + glm::vec3(size(rng), size(rng), size(rng)));
+}
+
+std::vector<int> queryAll(const DynamicAABBTree &tree, const AABB &aabb) {
+  std::vector<int> found;
+  tree.query(aabb, [&](int proxy) {
+    found.push_back(proxy);
+    return true;
+  });
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+// Leaves are fattened, so a query must report exactly the proxies whose fat
+// boxes overlap, which always includes every proxy whose box does
+void testQueryMatchesBruteForce() {
+  std::mt19937 rng(1);
+  const float margin = 0.1f;
+  DynamicAABBTree tree(margin);
+  std::vector<int> proxies;
+  std::vector<AABB> boxes;
+  for (int i = 0; i < 500; ++i) {
+    boxes.push_back(randomBox(rng));
+    proxies.push_back(tree.createProxy(boxes.back(), EntityID(i)));
+  }
+
+  // Move some a little, some far, and destroy a few
+  std::uniform_real_distribution<float> nudge(-0.05f, 0.05f);
+  std::vector<bool> alive(proxies.size(), true);
+  for (size_t i = 0; i < proxies.size(); ++i) {
+    if (i % 7 == 0) {
+      tree.destroyProxy(proxies[i]);
+      alive[i] = false;
+    } else if (i % 3 == 0) {
+      boxes[i] = randomBox(rng);
+      CHECK(tree.moveProxy(proxies[i], boxes[i]));
+    } else {
+      glm::vec3 offset(nudge(rng), nudge(rng), nudge(rng));
+      boxes[i] = AABB(boxes[i].min + offset, boxes[i].max + offset);
+      CHECK(!tree.moveProxy(proxies[i], boxes[i]));
+    }
+  }
+
+  for (int q = 0; q < 100; ++q) {
+    AABB query = randomBox(rng).fattened(3.0f);
+    std::vector<int> expected;
+    for (size_t i = 0; i < proxies.size(); ++i) {
+      if (!alive[i]) {
+        continue;
+      }
+      CHECK(tree.fatAABB(proxies[i]).contains(boxes[i]));
+      CHECK(tree.entity(proxies[i]) == EntityID(i));
+      if (tree.fatAABB(proxies[i]).overlaps(query)) {
+        expected.push_back(proxies[i]);
+      }
+    }
+    std::sort(expected.begin(), expected.end());
+    CHECK(queryAll(tree, query) == expected);
+  }
+}
+
+void testQueryStopsEarly() {
+  DynamicAABBTree tree;
+  for (int i = 0; i < 10; ++i) {
+    tree.createProxy(AABB(glm::vec3(0.0f), glm::vec3(1.0f)), EntityID(i));
+  }
+  int calls = 0;
+  tree.query(AABB(glm::vec3(0.0f), glm::vec3(1.0f)), [&](int) {
+    ++calls;
+    return false;
+  });
+  CHECK(calls == 1);
+}
+
+void testRaycastFindsClosestHit() {
+  std::mt19937 rng(2);
+  DynamicAABBTree tree;
+  std::vector<AABB> boxes;
+  for (int i = 0; i < 300; ++i) {
+    boxes.push_back(randomBox(rng));
+    tree.createProxy(boxes.back(), EntityID(i));
+  }
+
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  for (int r = 0; r < 100; ++r) {
+    glm::vec3 origin(unit(rng) * 60.0f, unit(rng) * 60.0f, unit(rng) * 60.0f);
+    glm::vec3 direction = glm::normalize(
+        glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(1e-3f));
+    const float maxDistance = 150.0f;
+
+    float expected = maxDistance;
+    bool expectHit = false;
+    for (const AABB &box : boxes) {
+      float distance;
+      if (box.raycast(origin, direction, maxDistance, distance) &&
+          distance <= expected) {
+        expected = distance;
+        expectHit = true;
+      }
+    }
+
+    // Clip the ray at every hit so only closer leaves are visited
+    float closest = maxDistance;
+    bool hit = false;
+    tree.raycast(origin, direction, maxDistance, [&](int, float distance) {
+      hit = true;
+      closest = std::min(closest, distance);
+      return closest;
+    });
+    CHECK(hit == expectHit);
+    if (hit && expectHit) {
+      CHECK(std::abs(closest - expected) < 1e-4f);
+    }
+  }
+}
+
+// Rotations keep the tree logarithmic even for sorted insertions, which
+// would degenerate into a list without them
+void testStaysBalanced() {
+  DynamicAABBTree tree;
+  const int count = 1024;
+  for (int i = 0; i < count; ++i) {
+    glm::vec3 min(float(i), 0.0f, 0.0f);
+    tree.createProxy(AABB(min, min + glm::vec3(0.5f)), EntityID(i));
+  }
+  CHECK(tree.height() <= 2 * int(std::log2(count)));
+
+  tree.clear();
+  CHECK(queryAll(tree, AABB(glm::vec3(-1e3f), glm::vec3(1e3f))).empty());
+}
+} // unnamed namespace
+
+int main() {
+  testQueryMatchesBruteForce();
+  testQueryStopsEarly();
+  testRaycastFindsClosestHit();
+  testStaysBalanced();
+  return testResult("DynamicAABBTreeTest");
+}
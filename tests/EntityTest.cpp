@@ -0,0 +1,100 @@
+#include "Check.h"
+#include "components/Collidable.h"
+#include "components/Position.h"
+#include "components/Velocity.h"
+#include "managers/ComponentManager.h"
+
+namespace {
+void testGenerations() {
+  EntityManager entityManager;
+  EntityID first = entityManager.createEntity();
+  entityManager.destroyEntity(first);
+  EntityID second = entityManager.createEntity();
+
+  // The slot is reused under a new generation
+  CHECK(entityIndex(second) == entityIndex(first));
+  CHECK(entityGeneration(second) != entityGeneration(first));
+  CHECK(!entityManager.isAlive(first));
+  CHECK(entityManager.isAlive(second));
+  CHECK(entityManager.entityCount() == 1);
+
+  // Destroying through a stale handle leaves the new entity alone
+  entityManager.destroyEntity(first);
+  CHECK(entityManager.isAlive(second));
+}
+
+// Destroy an entity, let another take its slot, then write through the old
+// handle: nothing of the new entity may change
+void testStaleHandleWrites(StorageMode mode) {
+  EntityManager entityManager;
+  ComponentManager componentManager(mode);
+  EntityID stale = entityManager.createEntity();
+  componentManager.addComponent(stale, Position(1.0f, 0.0f, 0.0f),
+                                entityManager);
+  componentManager.destroyEntity(stale, entityManager);
+
+  EntityID entity = entityManager.createEntity();
+  CHECK(entityIndex(entity) == entityIndex(stale));
+  componentManager.addComponent(entity, Position(2.0f, 0.0f, 0.0f),
+                                entityManager);
+  componentManager.addComponent(entity, Collidable(), entityManager);
+
+  CHECK(!componentManager.addComponent(stale, Position(3.0f, 0.0f, 0.0f),
+                                       entityManager));
+  CHECK(!componentManager.addComponent(stale, Velocity(), entityManager));
+  CHECK(!componentManager.emplaceComponent<Velocity>(stale, entityManager));
+  componentManager.removeComponent<Position>(stale, entityManager);
+  componentManager.removeComponent<Collidable>(stale, entityManager);
+  componentManager.destroyEntity(stale, entityManager);
+
+  CHECK(entityManager.isAlive(entity));
+  Position *position = componentManager.getComponent<Position>(entity);
+  CHECK(position && position->x == 2.0f);
+  CHECK(!componentManager.getComponent<Velocity>(entity));
+  const ComponentMask &mask = entityManager.getComponentMask(entity);
+  CHECK(mask.test(ComponentType<Position>::ID()));
+  CHECK(mask.test(ComponentType<Collidable>::ID()));
+  CHECK(!mask.test(ComponentType<Velocity>::ID()));
+
+  // Reads through the stale handle see nothing
+  CHECK(!componentManager.getComponent<Position>(stale));
+  CHECK(entityManager.getComponentMask(stale).none());
+  entityManager.setComponentBit(stale, ComponentType<Velocity>::ID(), true);
+  CHECK(!entityManager.getComponentMask(entity).test(
+      ComponentType<Velocity>::ID()));
+
+  size_t matches = 0;
+  componentManager.view<Position, Collidable>(entityManager)
+      .each([&](EntityID match, Position &, Collidable &) {
+        ++matches;
+        CHECK(match == entity);
+      });
+  CHECK(matches == 1);
+}
+
+// The pool itself refuses to hand a stale handle another generation's slot
+void testPoolRejectsOtherGeneration() {
+  ComponentPool<Position> pool;
+  EntityID current = makeEntityID(3, 1);
+  EntityID stale = makeEntityID(3, 0);
+  CHECK(pool.emplace(current, 1.0f, 0.0f, 0.0f));
+  CHECK(!pool.emplace(stale, 2.0f, 0.0f, 0.0f));
+  CHECK(!pool.hasComponent(stale));
+  pool.removeComponent(stale);
+  CHECK(pool.size() == 1);
+  CHECK(pool.getComponent(current) && pool.getComponent(current)->x == 1.0f);
+
+  // Overwriting its own component is fine
+  CHECK(pool.emplace(current, 4.0f, 0.0f, 0.0f));
+  CHECK(pool.size() == 1);
+  CHECK(pool.getComponent(current)->x == 4.0f);
+}
+} // unnamed namespace
+
+int main() {
+  testGenerations();
+  testStaleHandleWrites(StorageMode::SparseSet);
+  testStaleHandleWrites(StorageMode::Archetype);
+  testPoolRejectsOtherGeneration();
+  return testResult("EntityTest");
+}
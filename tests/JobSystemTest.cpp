@@ -0,0 +1,72 @@
+#include "Check.h"
+#include "core/JobSystem.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+// A job runs only after all of its dependencies, here a diamond a -> b, c -> d
+void testDependencies(size_t workerCount) {
+  JobSystem jobs(workerCount);
+  for (int round = 0; round < 200; ++round) {
+    std::mutex mutex;
+    std::vector<char> order;
+    auto record = [&](char name) {
+      return [&, name]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(name);
+      };
+    };
+
+    JobSystem::JobHandle a = jobs.schedule(record('a'));
+    JobSystem::JobHandle b = jobs.schedule(record('b'), {a});
+    JobSystem::JobHandle c = jobs.schedule(record('c'), {a});
+    JobSystem::JobHandle d = jobs.schedule(record('d'), {b, c});
+    jobs.wait(d);
+
+    CHECK(jobs.isFinished(a) && jobs.isFinished(b) && jobs.isFinished(c));
+    CHECK(order.size() == 4);
+    if (order.size() == 4) {
+      CHECK(order.front() == 'a');
+      CHECK(order.back() == 'd');
+    }
+  }
+}
+
+// Depending on a job that already finished doesn't hold anything up
+void testFinishedDependency() {
+  JobSystem jobs(2);
+  JobSystem::JobHandle first = jobs.schedule([]() {});
+  jobs.wait(first);
+  std::atomic<bool> ran{false};
+  jobs.wait(jobs.schedule([&]() { ran = true; }, {first}));
+  CHECK(ran);
+}
+
+void testParallelForCoversEveryIndexOnce(size_t workerCount) {
+  JobSystem jobs(workerCount);
+  for (size_t count : {0, 1, 63, 64, 1000}) {
+    std::vector<std::atomic<int>> visits(count);
+    jobs.parallelFor(count, 64, [&](size_t begin, size_t end) {
+      CHECK(begin < end);
+      // Without workers the whole range runs in one call
+      CHECK(workerCount == 0 || end - begin <= 64);
+      for (size_t i = begin; i < end; ++i) {
+        ++visits[i];
+      }
+    });
+    for (size_t i = 0; i < count; ++i) {
+      CHECK(visits[i] == 1);
+    }
+  }
+}
+} // unnamed namespace
+
+int main() {
+  testDependencies(0);
+  testDependencies(4);
+  testFinishedDependency();
+  testParallelForCoversEveryIndexOnce(0);
+  testParallelForCoversEveryIndexOnce(4);
+  return testResult("JobSystemTest");
+}
@@ -0,0 +1,111 @@
+#include "Check.h"
+#include "physics/OBB.h"
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+namespace {
+bool near(float a, float b) { return std::abs(a - b) < 1e-4f; }
+
+bool near(const glm::vec3 &a, const glm::vec3 &b) {
+  return near(a.x, b.x) && near(a.y, b.y) && near(a.z, b.z);
+}
+
+glm::quat aroundZ(float angle) {
+  return glm::angleAxis(angle, glm::vec3(0.0f, 0.0f, 1.0f));
+}
+
+void testAxisAligned() {
+  OBB a(glm::vec3(0.0f), glm::vec3(1.0f));
+  glm::vec3 normal;
+  float depth;
+
+  CHECK(intersectOBB(a, OBB(glm::vec3(1.5f, 0.0f, 0.0f), glm::vec3(1.0f)),
+                     normal, depth));
+  CHECK(near(depth, 0.5f));
+  // Points from b towards a
+  CHECK(near(normal, glm::vec3(-1.0f, 0.0f, 0.0f)));
+
+  // Touching counts, with no depth
+  CHECK(intersectOBB(a, OBB(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(1.0f)),
+                     normal, depth));
+  CHECK(near(depth, 0.0f));
+
+  CHECK(!intersectOBB(a, OBB(glm::vec3(0.0f, 0.0f, 2.5f), glm::vec3(1.0f)),
+                      normal, depth));
+}
+
+// A box turned 45 degrees whose bounds overlap a neighbour's, while the
+// boxes themselves are apart along the turned face's normal
+void testRotatedSeparatedByFaceAxis() {
+  OBB a(glm::vec3(0.0f), glm::vec3(1.0f), aroundZ(glm::quarter_pi<float>()));
+  OBB b(glm::vec3(2.0f, 2.0f, 0.0f), glm::vec3(1.0f));
+  CHECK(a.bounds().overlaps(b.bounds()));
+
+  glm::vec3 normal;
+  float depth;
+  CHECK(!intersectOBB(a, b, normal, depth));
+
+  // Moved closer along the diagonal, the turned face is the contact face
+  OBB closer(glm::vec3(1.2f, 1.2f, 0.0f), glm::vec3(1.0f));
+  CHECK(intersectOBB(a, closer, normal, depth));
+  float diagonal = std::sqrt(2.0f);
+  CHECK(near(depth, 1.0f + diagonal - 1.2f * diagonal));
+  CHECK(near(normal, -glm::vec3(1.0f, 1.0f, 0.0f) / diagonal));
+}
+
+// Two boxes twisted about different axes only separate on an edge-edge axis
+void testEdgeAxis() {
+  OBB a(glm::vec3(0.0f), glm::vec3(1.0f),
+        glm::angleAxis(glm::quarter_pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f)));
+  OBB b(glm::vec3(0.0f, 2.9f, 0.0f), glm::vec3(1.0f),
+        glm::angleAxis(glm::quarter_pi<float>(), glm::vec3(0.0f, 0.0f, 1.0f)));
+  glm::vec3 normal;
+  float depth;
+  // Both edges reach sqrt(2) towards each other, 2.83 in total
+  CHECK(!intersectOBB(a, b, normal, depth));
+  b.center.y = 2.7f;
+  CHECK(intersectOBB(a, b, normal, depth));
+  CHECK(near(depth, 2.0f * std::sqrt(2.0f) - 2.7f));
+  CHECK(near(normal, glm::vec3(0.0f, -1.0f, 0.0f)));
+}
+
+// Swapping the boxes flips the normal, the depth stays
+void testSymmetric() {
+  OBB a(glm::vec3(0.3f, 0.1f, -0.2f), glm::vec3(1.0f, 0.5f, 2.0f),
+        aroundZ(0.4f));
+  OBB b(glm::vec3(1.2f, 0.7f, 0.4f), glm::vec3(0.6f, 1.0f, 0.5f),
+        glm::angleAxis(1.1f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f))));
+  glm::vec3 normalAB, normalBA;
+  float depthAB, depthBA;
+  CHECK(intersectOBB(a, b, normalAB, depthAB));
+  CHECK(intersectOBB(b, a, normalBA, depthBA));
+  CHECK(near(depthAB, depthBA));
+  CHECK(near(normalAB, -normalBA));
+}
+
+void testSweep() {
+  OBB target(glm::vec3(0.0f), glm::vec3(1.0f));
+  SweepHit hit;
+
+  CHECK(sweepOBB(OBB(glm::vec3(-5.0f, 0.0f, 0.0f), glm::vec3(1.0f)),
+                 glm::vec3(10.0f, 0.0f, 0.0f), target, hit));
+  CHECK(near(hit.time, 0.3f));
+  CHECK(near(hit.normal, glm::vec3(-1.0f, 0.0f, 0.0f)));
+
+  // Passes above the target
+  CHECK(!sweepOBB(OBB(glm::vec3(-5.0f, 2.5f, 0.0f), glm::vec3(1.0f)),
+                  glm::vec3(10.0f, 0.0f, 0.0f), target, hit));
+  // Stops short of it
+  CHECK(!sweepOBB(OBB(glm::vec3(-5.0f, 0.0f, 0.0f), glm::vec3(1.0f)),
+                  glm::vec3(2.0f, 0.0f, 0.0f), target, hit));
+}
+} // unnamed namespace
+
+int main() {
+  testAxisAligned();
+  testRotatedSeparatedByFaceAxis();
+  testEdgeAxis();
+  testSymmetric();
+  testSweep();
+  return testResult("OBBTest");
+}
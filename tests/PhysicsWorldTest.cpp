@@ -0,0 +1,149 @@
+#include "Check.h"
+#include "physics/PhysicsWorld.h"
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+const BroadphaseType TYPES[] = {BroadphaseType::DynamicTree,
+                                BroadphaseType::SpatialHashGrid,
+                                BroadphaseType::SweepAndPrune};
+
+glm::quat randomOrientation(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  glm::quat orientation(unit(rng), unit(rng), unit(rng), unit(rng));
+  return glm::length(orientation) < 1e-3f ? glm::quat(1.0f, 0.0f, 0.0f, 0.0f)
+                                          : glm::normalize(orientation);
+}
+
+// A world and the boxes it holds, for brute force answers
+struct Scene {
+  PhysicsWorld world;
+  std::map<EntityID, OBB> boxes;
+};
+
+void buildScene(Scene &scene, std::mt19937 &rng) {
+  std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+  std::uniform_real_distribution<float> size(0.2f, 3.0f);
+  for (EntityID entity = 0; entity < 150; ++entity) {
+    OBB box(glm::vec3(position(rng), position(rng), position(rng)),
+            glm::vec3(size(rng), size(rng), size(rng)),
+            randomOrientation(rng));
+    scene.world.addCollider(entity, box, entity % 2 == 0);
+    scene.boxes[entity] = box;
+  }
+}
+
+glm::vec3 randomDirection(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  glm::vec3 direction(unit(rng), unit(rng), unit(rng));
+  return glm::length(direction) < 1e-3f ? glm::vec3(1.0f, 0.0f, 0.0f)
+                                        : glm::normalize(direction);
+}
+
+// Casts walk the broadphase and must find the same nearest hit as testing
+// every box
+void testCastsMatchBruteForce(BroadphaseType type) {
+  std::mt19937 rng(7);
+  Scene scene{PhysicsWorld(createBroadphase(type)), {}};
+  buildScene(scene, rng);
+  std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+  std::uniform_real_distribution<float> radius(0.1f, 4.0f);
+  const float maxDistance = 60.0f;
+
+  for (int cast = 0; cast < 200; ++cast) {
+    glm::vec3 origin(position(rng), position(rng), position(rng));
+    glm::vec3 direction = randomDirection(rng);
+    EntityID ignored = cast % 3 == 0 ? EntityID(cast % 150) : INVALID_ENTITY;
+
+    float sphereRadius = radius(rng);
+    float nearest = maxDistance;
+    bool expectHit = false;
+    for (const auto &[entity, box] : scene.boxes) {
+      float distance;
+      glm::vec3 normal;
+      if (entity != ignored &&
+          box.fattened(sphereRadius).raycast(origin, direction, maxDistance,
+                                             distance, normal) &&
+          distance <= nearest) {
+        nearest = distance;
+        expectHit = true;
+      }
+    }
+    QueryHit hit;
+    CHECK(scene.world.sphereCast(origin, sphereRadius, direction, maxDistance,
+                                 hit, ignored) == expectHit);
+    if (expectHit) {
+      CHECK(std::abs(hit.distance - nearest) < 1e-3f);
+    }
+
+    OBB shape(origin, glm::vec3(radius(rng), radius(rng), radius(rng)),
+              randomOrientation(rng));
+    glm::vec3 displacement = direction * maxDistance;
+    nearest = maxDistance;
+    expectHit = false;
+    for (const auto &[entity, box] : scene.boxes) {
+      SweepHit sweep;
+      if (entity != ignored && sweepOBB(shape, displacement, box, sweep) &&
+          sweep.time * maxDistance <= nearest) {
+        nearest = sweep.time * maxDistance;
+        expectHit = true;
+      }
+    }
+    CHECK(scene.world.boxCast(shape, direction, maxDistance, hit, ignored) ==
+          expectHit);
+    if (expectHit) {
+      CHECK(std::abs(hit.distance - nearest) < 1e-3f);
+    }
+  }
+}
+
+void testInvalidDistances() {
+  PhysicsWorld world;
+  world.addCollider(1, OBB(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(1.0f)),
+                    true);
+  glm::vec3 forward(0.0f, 0.0f, 1.0f);
+  QueryHit hit;
+  CHECK(world.raycast(glm::vec3(0.0f), forward, 20.0f, hit));
+  CHECK(hit.entity == 1);
+
+  const float infinity = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  for (float distance : {infinity, nan, -1.0f}) {
+    CHECK(!world.raycast(glm::vec3(0.0f), forward, distance, hit));
+    CHECK(hit.entity == INVALID_ENTITY);
+    CHECK(!world.sphereCast(glm::vec3(0.0f), 0.5f, forward, distance, hit));
+    CHECK(!world.boxCast(OBB(glm::vec3(0.0f), glm::vec3(0.5f)), forward,
+                         distance, hit));
+  }
+}
+
+void testOverlapBoxAppends() {
+  PhysicsWorld world;
+  world.addCollider(1, OBB(glm::vec3(0.0f), glm::vec3(1.0f)), true);
+  world.addCollider(2, OBB(glm::vec3(3.0f, 0.0f, 0.0f), glm::vec3(1.0f)),
+                    false);
+  // Bounds overlap the query, the turned box itself doesn't
+  glm::quat turned =
+      glm::angleAxis(glm::quarter_pi<float>(), glm::vec3(0.0f, 0.0f, 1.0f));
+  world.addCollider(
+      3, OBB(glm::vec3(0.0f, 2.9f, 0.0f), glm::vec3(1.0f), turned), false);
+
+  std::vector<EntityID> results{42};
+  world.overlapBox(OBB(glm::vec3(1.5f, 0.5f, 0.0f), glm::vec3(1.0f)),
+                   results, 2);
+  CHECK(results == std::vector<EntityID>({42, 1}));
+}
+} // unnamed namespace
+
+int main() {
+  for (BroadphaseType type : TYPES) {
+    testCastsMatchBruteForce(type);
+  }
+  testInvalidDistances();
+  testOverlapBoxAppends();
+  return testResult("PhysicsWorldTest");
+}
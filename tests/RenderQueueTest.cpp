@@ -0,0 +1,85 @@
+#include "Check.h"
+#include "rendering/RenderQueue.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+using Entry = RenderQueue::Entry;
+
+// The radix sort must give the same order as a stable comparison sort
+void testSortMatchesStableSort() {
+  std::mt19937_64 rng(3);
+  for (size_t count : {0, 1, 2, 17, 1000, 5000}) {
+    RenderQueue queue;
+    std::vector<Entry> expected;
+    for (size_t i = 0; i < count; ++i) {
+      // Few distinct keys, so the stability of equal keys matters
+      uint64_t key = rng() % 64;
+      key = (key << 56) | ((rng() % 4) << 24) | (rng() % 8);
+      queue.push(key, uint32_t(i));
+      expected.push_back(Entry{key, uint32_t(i)});
+    }
+    queue.sort();
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const Entry &a, const Entry &b) {
+                       return a.key < b.key;
+                     });
+
+    CHECK(queue.size() == count);
+    for (size_t i = 0; i < std::min(count, queue.size()); ++i) {
+      CHECK(queue[i].key == expected[i].key);
+      CHECK(queue[i].item == expected[i].item);
+    }
+  }
+}
+
+// Keys that share every byte leave the input order alone
+void testSortWithUniformKeys() {
+  RenderQueue queue;
+  for (uint32_t i = 0; i < 100; ++i) {
+    queue.push(0x0123456789ABCDEFull, i);
+  }
+  queue.sort();
+  for (uint32_t i = 0; i < queue.size(); ++i) {
+    CHECK(queue[i].item == i);
+  }
+
+  queue.clear();
+  CHECK(queue.size() == 0);
+  queue.sort();
+  CHECK(queue.size() == 0);
+}
+
+void testKeyLayout() {
+  using Pass = RenderQueue::Pass;
+  uint64_t nearKey = RenderQueue::makeKey(Pass::Opaque, 1, 2, 3, 1.0f);
+  uint64_t farKey = RenderQueue::makeKey(Pass::Opaque, 1, 2, 3, 10.0f);
+  // Opaque draws go front to back, transparent ones back to front
+  CHECK(nearKey < farKey);
+  CHECK(RenderQueue::makeKey(Pass::Transparent, 1, 2, 3, 10.0f) <
+        RenderQueue::makeKey(Pass::Transparent, 1, 2, 3, 1.0f));
+  // Every opaque draw comes before every transparent one
+  CHECK(RenderQueue::makeKey(Pass::Opaque, 63, 0xFFFF, 0xFFFF, 1e6f) <
+        RenderQueue::makeKey(Pass::Transparent, 0, 0, 0, 0.0f));
+  // State outranks material, which outranks depth
+  CHECK(RenderQueue::makeKey(Pass::Opaque, 1, 2, 4, 0.0f) > farKey);
+  CHECK(RenderQueue::makeKey(Pass::Opaque, 1, 3, 0, 0.0f) >
+        RenderQueue::makeKey(Pass::Opaque, 1, 2, 0xFFFF, 1e6f));
+
+  // Material and depth don't split a batch, mesh does
+  CHECK(RenderQueue::batchOf(nearKey) == RenderQueue::batchOf(farKey));
+  CHECK(RenderQueue::batchOf(nearKey) !=
+        RenderQueue::batchOf(RenderQueue::makeKey(Pass::Opaque, 1, 3, 3, 1.0f)));
+  // Negative depths clamp to 0
+  CHECK(RenderQueue::makeKey(Pass::Opaque, 1, 2, 3, -5.0f) ==
+        RenderQueue::makeKey(Pass::Opaque, 1, 2, 3, 0.0f));
+}
+} // unnamed namespace
+
+int main() {
+  testSortMatchesStableSort();
+  testSortWithUniformKeys();
+  testKeyLayout();
+  return testResult("RenderQueueTest");
+}
@@ -0,0 +1,208 @@
+#include "Check.h"
+#include "physics/SweepAndPrune.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+using Pair = std::pair<EntityID, EntityID>;
+
+Pair makePair(EntityID a, EntityID b) {
+  return {std::min(a, b), std::max(a, b)};
+}
+
+AABB randomBox(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+  std::uniform_real_distribution<float> size(0.1f, 6.0f);
+  glm::vec3 min(position(rng), position(rng), position(rng));
+  return AABB(min, min + glm::vec3(size(rng), size(rng), size(rng)));
+}
+
+struct Box {
+  AABB aabb;
+  bool isStatic;
+};
+
+// Pairs of overlapping boxes with at least one dynamic box
+std::set<Pair> expectedPairs(const std::map<EntityID, Box> &boxes) {
+  std::set<Pair> pairs;
+  for (auto a = boxes.begin(); a != boxes.end(); ++a) {
+    for (auto b = std::next(a); b != boxes.end(); ++b) {
+      if (!(a->second.isStatic && b->second.isStatic) &&
+          a->second.aabb.overlaps(b->second.aabb)) {
+        pairs.insert(makePair(a->first, b->first));
+      }
+    }
+  }
+  return pairs;
+}
+
+std::set<Pair> trackedPairs(const SweepAndPrune &sap,
+                            const std::map<EntityID, Box> &boxes) {
+  std::set<Pair> pairs;
+  for (const auto &[entity, box] : boxes) {
+    std::vector<EntityID> others;
+    sap.pairsOf(entity, others);
+    for (EntityID other : others) {
+      pairs.insert(makePair(entity, other));
+    }
+  }
+  return pairs;
+}
+
+// The tracked pairs must match brute force after every round of edits, and
+// every pair that went away must have been reported as removed
+void testPairsMatchBruteForce() {
+  std::mt19937 rng(7);
+  SweepAndPrune sap;
+  CHECK(sap.tracksPairs());
+  std::map<EntityID, Box> boxes;
+  EntityID nextEntity = 0;
+  for (; nextEntity < 200; ++nextEntity) {
+    Box box{randomBox(rng), nextEntity % 4 == 0};
+    sap.insertProxy(nextEntity, box.aabb, box.isStatic);
+    boxes[nextEntity] = box;
+  }
+
+  std::set<Pair> previous = expectedPairs(boxes);
+  CHECK(trackedPairs(sap, boxes) == previous);
+  CHECK(sap.pairCount() == previous.size());
+  std::vector<Pair> removed;
+  sap.takeRemovedPairs(removed);
+
+  std::uniform_real_distribution<float> nudge(-1.0f, 1.0f);
+  for (int round = 0; round < 20; ++round) {
+    for (auto it = boxes.begin(); it != boxes.end();) {
+      auto &[entity, box] = *it;
+      // Removing most of the proxies over the rounds forces compaction
+      if (rng() % 6 == 0) {
+        sap.removeProxy(entity);
+        it = boxes.erase(it);
+        continue;
+      }
+      if (!box.isStatic) {
+        glm::vec3 offset(nudge(rng), nudge(rng), nudge(rng));
+        box.aabb = AABB(box.aabb.min + offset, box.aabb.max + offset);
+        sap.moveProxy(entity, box.aabb);
+      }
+      ++it;
+    }
+    for (int i = 0; i < 5; ++i, ++nextEntity) {
+      Box box{randomBox(rng), false};
+      sap.insertProxy(nextEntity, box.aabb, box.isStatic);
+      boxes[nextEntity] = box;
+    }
+
+    std::set<Pair> current = expectedPairs(boxes);
+    CHECK(trackedPairs(sap, boxes) == current);
+    CHECK(sap.pairCount() == current.size());
+
+    removed.clear();
+    sap.takeRemovedPairs(removed);
+    std::set<Pair> reported;
+    for (const Pair &pair : removed) {
+      reported.insert(makePair(pair.first, pair.second));
+    }
+    for (const Pair &pair : previous) {
+      if (!current.count(pair)) {
+        CHECK(reported.count(pair));
+      }
+    }
+    previous = current;
+
+    // Queries skip removed endpoints and still find touching boxes
+    for (int q = 0; q < 20; ++q) {
+      AABB query = randomBox(rng);
+      std::vector<EntityID> expected;
+      for (const auto &[entity, box] : boxes) {
+        if (box.aabb.overlaps(query)) {
+          expected.push_back(entity);
+        }
+      }
+      std::vector<EntityID> results;
+      sap.query(query, results);
+      std::sort(results.begin(), results.end());
+      CHECK(results == expected);
+    }
+  }
+}
+
+void testTouchingBoxesPair() {
+  SweepAndPrune sap;
+  AABB left(glm::vec3(0.0f), glm::vec3(1.0f));
+  AABB right(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(2.0f, 1.0f, 1.0f));
+  sap.insertProxy(1, left, true);
+  sap.insertProxy(2, right, false);
+  std::vector<EntityID> others;
+  sap.pairsOf(2, others);
+  CHECK(others == std::vector<EntityID>{1});
+
+  // A query box just past a long box's start still finds it
+  sap.insertProxy(3, AABB(glm::vec3(-100.0f), glm::vec3(-50.0f)), false);
+  std::vector<EntityID> results;
+  sap.query(AABB(glm::vec3(-50.0f), glm::vec3(-49.0f)), results);
+  CHECK(results == std::vector<EntityID>{3});
+
+  sap.removeProxy(1);
+  std::vector<Pair> removed;
+  sap.takeRemovedPairs(removed);
+  CHECK(removed.size() == 1);
+  others.clear();
+  sap.pairsOf(2, others);
+  CHECK(others.empty());
+}
+
+// Rays walk the boxes in the order they reach them, so clipping at the first
+// hit skips the rest, and infinite distances don't turn into NaN
+void testRaycastInRayOrder() {
+  SweepAndPrune sap;
+  for (EntityID entity = 0; entity < 10; ++entity) {
+    glm::vec3 min(entity * 4.0f, 0.0f, 0.0f);
+    sap.insertProxy(entity, AABB(min, min + glm::vec3(2.0f)), false);
+  }
+  sap.removeProxy(5);
+  const float infinity = std::numeric_limits<float>::infinity();
+
+  std::vector<EntityID> hits;
+  auto clipAtHit = [&](const RaycastHit &hit) {
+    hits.push_back(hit.entity);
+    return hit.distance;
+  };
+  sap.raycast(glm::vec3(-10.0f, 1.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+              infinity, clipAtHit);
+  CHECK(hits == std::vector<EntityID>{0});
+  hits.clear();
+  sap.raycast(glm::vec3(100.0f, 1.0f, 1.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+              infinity, clipAtHit);
+  CHECK(hits == std::vector<EntityID>{9});
+  hits.clear();
+  sap.raycast(glm::vec3(21.0f, 1.0f, 1.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+              infinity, clipAtHit);
+  CHECK(hits == std::vector<EntityID>{4});
+
+  // Without clipping every box on the ray is found
+  hits.clear();
+  sap.raycast(glm::vec3(100.0f, 1.0f, 1.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+              infinity, [&](const RaycastHit &hit) {
+                hits.push_back(hit.entity);
+                return infinity;
+              });
+  CHECK(hits.size() == 9);
+
+  hits.clear();
+  sap.raycast(glm::vec3(13.0f, -50.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+              infinity, clipAtHit);
+  CHECK(hits == std::vector<EntityID>{3});
+}
+} // unnamed namespace
+
+int main() {
+  testPairsMatchBruteForce();
+  testTouchingBoxesPair();
+  testRaycastInRayOrder();
+  return testResult("SweepAndPruneTest");
+}
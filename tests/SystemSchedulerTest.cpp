@@ -0,0 +1,157 @@
+#include "Check.h"
+#include "components/Position.h"
+#include "components/Renderable.h"
+#include "components/Rotation.h"
+#include "components/Scale.h"
+#include "components/Velocity.h"
+#include "core/SystemScheduler.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace {
+class TestSystem : public System {
+public:
+  explicit TestSystem(bool mainThread = false) {
+    setRunsOnMainThread(mainThread);
+  }
+
+  template <typename... Ts> TestSystem &reads() {
+    readsComponents<Ts...>();
+    return *this;
+  }
+  template <typename... Ts> TestSystem &writes() {
+    writesComponents<Ts...>();
+    return *this;
+  }
+
+  void update(float, EntityManager &, ComponentManager &) override {
+    if (body) {
+      body();
+    }
+  }
+  void sync() override { ++syncs; }
+
+  std::function<void()> body;
+  int syncs = 0;
+};
+
+// Spins until flag is set, giving up after a second
+bool waitFor(const std::atomic<bool> &flag) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (!flag) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+void testLevels() {
+  JobSystem jobs(2);
+  SystemScheduler scheduler(jobs);
+  TestSystem movement, unrelated, physics, reader, otherReader;
+  movement.reads<Rotation>().writes<Velocity>();
+  // Touches none of movement's components
+  unrelated.reads<Renderable3D>().writes<Scale>();
+  // Reads what movement writes
+  physics.reads<Velocity>().writes<Position>();
+  // Readers of the same component don't conflict
+  reader.reads<Position, Scale>();
+  otherReader.reads<Position, Renderable3D>();
+  for (TestSystem *system :
+       {&movement, &unrelated, &physics, &reader, &otherReader}) {
+    scheduler.addSystem(*system);
+  }
+
+  std::vector<size_t> levels = scheduler.levels();
+  CHECK(levels.size() == 5);
+  if (levels.size() == 5) {
+    CHECK(levels[0] == 0);
+    CHECK(levels[1] == 0);
+    CHECK(levels[2] == 1);
+    // After physics' Position writes, and unrelated's Scale writes
+    CHECK(levels[3] == 2);
+    CHECK(levels[4] == 2);
+  }
+}
+
+// Like render extraction and submission: a worker system reading components
+// and a main-thread system with no component access overlap
+void testNonConflictingSystemsOverlap() {
+  JobSystem jobs(2);
+  SystemScheduler scheduler(jobs);
+  TestSystem extraction;
+  TestSystem submission(true);
+  extraction.reads<Position, Rotation, Scale, Renderable3D>();
+  scheduler.addSystem(extraction);
+  scheduler.addSystem(submission);
+
+  CHECK(!extraction.conflictsWith(submission));
+  std::vector<size_t> levels = scheduler.levels();
+  CHECK(levels == std::vector<size_t>({0, 0}));
+
+  // Each one waits inside update until the other one has started
+  std::atomic<bool> extractionStarted{false};
+  std::atomic<bool> submissionStarted{false};
+  bool extractionSawSubmission = false;
+  bool submissionSawExtraction = false;
+  std::thread::id mainThread = std::this_thread::get_id();
+  std::thread::id submissionThread;
+  extraction.body = [&]() {
+    extractionStarted = true;
+    extractionSawSubmission = waitFor(submissionStarted);
+  };
+  submission.body = [&]() {
+    submissionStarted = true;
+    submissionThread = std::this_thread::get_id();
+    submissionSawExtraction = waitFor(extractionStarted);
+  };
+
+  EntityManager entityManager;
+  ComponentManager componentManager;
+  scheduler.run(0.0f, entityManager, componentManager);
+  CHECK(extractionSawSubmission);
+  CHECK(submissionSawExtraction);
+  CHECK(submissionThread == mainThread);
+  // Both are synced once everything has finished
+  CHECK(extraction.syncs == 1);
+  CHECK(submission.syncs == 1);
+}
+
+void testConflictingSystemsRunInOrder() {
+  JobSystem jobs(2);
+  SystemScheduler scheduler(jobs);
+  TestSystem writer, reader;
+  writer.writes<Position>();
+  reader.reads<Position>();
+  scheduler.addSystem(writer);
+  scheduler.addSystem(reader);
+  CHECK(scheduler.levels() == std::vector<size_t>({0, 1}));
+
+  for (int round = 0; round < 100; ++round) {
+    std::atomic<bool> writerDone{false};
+    bool readerSawWrite = false;
+    writer.body = [&]() {
+      std::this_thread::yield();
+      writerDone = true;
+    };
+    reader.body = [&]() { readerSawWrite = writerDone; };
+
+    EntityManager entityManager;
+    ComponentManager componentManager;
+    scheduler.run(0.0f, entityManager, componentManager);
+    CHECK(readerSawWrite);
+  }
+}
+} // unnamed namespace
+
+int main() {
+  testLevels();
+  testNonConflictingSystemsOverlap();
+  testConflictingSystemsRunInOrder();
+  return testResult("SystemSchedulerTest");
+}
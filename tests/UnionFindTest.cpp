@@ -0,0 +1,49 @@
+#include "Check.h"
+#include "physics/UnionFind.h"
+
+namespace {
+void testUnite() {
+  UnionFind sets(6);
+  for (size_t i = 0; i < 6; ++i) {
+    CHECK(sets.find(i) == i);
+  }
+
+  sets.unite(0, 1);
+  sets.unite(2, 3);
+  sets.unite(1, 3);
+  sets.unite(3, 3);
+  CHECK(sets.find(0) == sets.find(2));
+  CHECK(sets.find(1) == sets.find(3));
+  CHECK(sets.find(4) != sets.find(0));
+  CHECK(sets.find(4) != sets.find(5));
+}
+
+// A long chain ends up as one set, whatever the order of the unions
+void testChain() {
+  const size_t count = 10000;
+  UnionFind sets(count);
+  for (size_t i = count - 1; i > 0; --i) {
+    sets.unite(i, i - 1);
+  }
+  size_t root = sets.find(0);
+  for (size_t i = 0; i < count; ++i) {
+    CHECK(sets.find(i) == root);
+  }
+}
+
+void testReset() {
+  UnionFind sets(3);
+  sets.unite(0, 2);
+  sets.reset(4);
+  for (size_t i = 0; i < 4; ++i) {
+    CHECK(sets.find(i) == i);
+  }
+}
+} // unnamed namespace
+
+int main() {
+  testUnite();
+  testChain();
+  testReset();
+  return testResult("UnionFindTest");
+}